@@ -0,0 +1,112 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Commands.hpp"
+
+#include "subcommand/Disable.hpp"
+#include "subcommand/Enable.hpp"
+#include "subcommand/List.hpp"
+#include "subcommand/Stats.hpp"
+#include "subcommand/Status.hpp"
+#include "version.h"
+
+#include <format>
+#include <sstream>
+
+static std::string failure_message(const CLI::App *app, const CLI::Error &e) {
+    return std::format("Invalid command line arguments: {}\n\n{}", e.what(), app->help());
+}
+
+void setup_app(CLI::App& app)
+{
+    app.description("HDRCmd " VERSION_FULL " - turn \"Use HDR\" on or off from command line");
+    app.allow_windows_style_options();
+    app.ignore_case();
+    app.require_subcommand(1);
+    app.failure_message(failure_message);
+
+    subcommand::Status::add(app);
+    subcommand::Enable::add(app);
+    subcommand::Disable::add(app);
+    subcommand::List::add(app);
+    subcommand::Stats::add(app);
+}
+
+int run_command(const CLI::App& app, std::ostream& out)
+{
+    const auto* subcmd = app.get_subcommands()[0];
+    return static_cast<const subcommand::Base*>(subcmd)->run(out);
+}
+
+int execute_command(const std::string& command_line, std::ostream& out)
+{
+    bool failed = false;
+    return execute_command(command_line, out, failed);
+}
+
+int execute_command(const std::string& command_line, std::ostream& out, bool& failed)
+{
+    CLI::App app;
+    setup_app(app);
+    try {
+        app.parse(command_line, false);
+    } catch (const CLI::ParseError& e) {
+        int exit_code = app.exit(e, out, out);
+        failed = exit_code != 0;
+        return exit_code;
+    }
+    const auto* subcmd = static_cast<const subcommand::Base*>(app.get_subcommands()[0]);
+    int exit_code = subcmd->run(out);
+    failed = subcmd->is_failure(exit_code);
+    return exit_code;
+}
+
+// Find a quote character not occurring in a string
+static std::optional<char> find_quote(const std::string& str)
+{
+    for (char quote : { '"', '\'', '`' }) {
+        if (str.find(quote) == std::string::npos)
+            return quote;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> make_command_line(std::span<const std::string> args)
+{
+    std::string command_line;
+    for (const auto& arg : args) {
+        // Line breaks would end the command
+        if (arg.find_first_of("\r\n") != std::string::npos)
+            return std::nullopt;
+
+        if (!command_line.empty())
+            command_line.push_back(' ');
+        if (!arg.empty() && arg.find_first_of(" \t\"'`") == std::string::npos) {
+            command_line.append(arg);
+            continue;
+        }
+
+        auto quote = find_quote(arg);
+        if (!quote)
+            return std::nullopt;
+        command_line.push_back(*quote);
+        command_line.append(arg);
+        command_line.push_back(*quote);
+    }
+    return command_line;
+}
@@ -0,0 +1,57 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMANDS_HPP_
+#define COMMANDS_HPP_
+
+#include "CLI/CLI.hpp"
+
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+/// Name of the IPC endpoint the server listens on
+inline constexpr std::string_view server_endpoint = "HDRCmd";
+
+/// Set up an app with options and the subcommands that can be executed directly as well as by a server
+void setup_app(CLI::App& app);
+
+/// Run the subcommand selected by a parsed app. Returns the exit code
+int run_command(const CLI::App& app, std::ostream& out);
+
+/**
+ * Parse a command line (without the program name) and execute it, writing output to \a out.
+ * Returns the exit code.
+ */
+int execute_command(const std::string& command_line, std::ostream& out);
+/**
+ * Parse a command line (without the program name) and execute it, writing output to \a out.
+ * Returns the exit code. \a failed is set to whether the exit code means failure, as opposed to
+ * a result, like the status returned by "status --mode exitcode".
+ */
+int execute_command(const std::string& command_line, std::ostream& out, bool& failed);
+
+/**
+ * Build a command line from arguments, suitable for execute_command().
+ * Returns an empty optional if some argument can't be quoted.
+ */
+std::optional<std::string> make_command_line(std::span<const std::string> args);
+
+#endif // COMMANDS_HPP_
@@ -0,0 +1,77 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DisplayChangeWatcher.hpp"
+
+static const wchar_t window_class_name[] = L"HDRCmdDisplayChangeWatcher";
+
+DisplayChangeWatcher::DisplayChangeWatcher(ChangeFunc change_func) : change_func(std::move(change_func))
+{
+    HANDLE ready_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    thread = std::thread([this, ready_event]() { Run(ready_event); });
+    // Wait for window creation, so hwnd is valid (or known to be null)
+    WaitForSingleObject(ready_event, INFINITE);
+    CloseHandle(ready_event);
+}
+
+DisplayChangeWatcher::~DisplayChangeWatcher()
+{
+    if (hwnd)
+        PostMessageW(hwnd, WM_CLOSE, 0, 0);
+    thread.join();
+}
+
+void DisplayChangeWatcher::Run(HANDLE ready_event)
+{
+    HINSTANCE instance = GetModuleHandleW(nullptr);
+    WNDCLASSEXW wcex = { sizeof(wcex) };
+    wcex.lpfnWndProc = &WndProc;
+    wcex.hInstance = instance;
+    wcex.lpszClassName = window_class_name;
+    RegisterClassExW(&wcex);
+
+    // A hidden top-level window: message-only windows don't receive broadcasts like WM_DISPLAYCHANGE
+    hwnd = CreateWindowExW(0, window_class_name, L"", WS_POPUP, 0, 0, 0, 0, nullptr, nullptr, instance, this);
+    SetEvent(ready_event);
+    if (!hwnd)
+        return;
+
+    MSG msg;
+    while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessageW(&msg);
+    }
+}
+
+LRESULT CALLBACK DisplayChangeWatcher::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    switch (message) {
+    case WM_NCCREATE:
+        SetWindowLongPtrW(hWnd, GWLP_USERDATA,
+                          reinterpret_cast<LONG_PTR>(reinterpret_cast<CREATESTRUCTW*>(lParam)->lpCreateParams));
+        break;
+    case WM_DISPLAYCHANGE:
+        if (auto* watcher = reinterpret_cast<DisplayChangeWatcher*>(GetWindowLongPtrW(hWnd, GWLP_USERDATA)))
+            watcher->change_func();
+        break;
+    case WM_DESTROY:
+        PostQuitMessage(0);
+        break;
+    }
+    return DefWindowProcW(hWnd, message, wParam, lParam);
+}
@@ -0,0 +1,51 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef DISPLAYCHANGEWATCHER_HPP_
+#define DISPLAYCHANGEWATCHER_HPP_
+
+#include "framework.h"
+
+#include <functional>
+#include <thread>
+
+/**
+ * Calls a function whenever the display configuration changes (WM_DISPLAYCHANGE).
+ * Uses a hidden window, running on its own thread; the function is called on that thread.
+ */
+class DisplayChangeWatcher
+{
+public:
+    using ChangeFunc = std::function<void()>;
+
+    explicit DisplayChangeWatcher(ChangeFunc change_func);
+    ~DisplayChangeWatcher();
+
+    DisplayChangeWatcher(const DisplayChangeWatcher&) = delete;
+    DisplayChangeWatcher& operator=(const DisplayChangeWatcher&) = delete;
+
+private:
+    ChangeFunc change_func;
+    HWND hwnd = nullptr;
+    std::thread thread;
+
+    void Run(HANDLE ready_event);
+    static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+};
+
+#endif // DISPLAYCHANGEWATCHER_HPP_
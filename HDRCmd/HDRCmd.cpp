@@ -18,38 +18,68 @@
 
 #include "CLI/CLI.hpp"
 
-#include "subcommand/Disable.hpp"
-#include "subcommand/Enable.hpp"
-#include "subcommand/Status.hpp"
-#include "version.h"
-#include "WinVerCheck.hpp"
+#include "Commands.hpp"
+#include "CommandServer.h"
+#include "subcommand/Batch.hpp"
+#include "subcommand/Serve.hpp"
+#include "subcommand/Watch.hpp"
+#include "OsCapabilities.h"
 
-#include <format>
+#include <optional>
+#include <string>
+#include <vector>
 
-static std::string failure_message(const CLI::App *app, const CLI::Error &e) {
-    return std::format("Invalid command line arguments: {}\n\n{}", e.what(), app->help());
+/**
+ * Forward the command to a running server, if any.
+ * Returns the exit code, or an empty optional if the command should be executed directly.
+ */
+static std::optional<int> forward_to_server(int argc, const wchar_t* const argv[])
+{
+    // Options like --help, the server itself, batches and watching are handled locally
+    if (argc < 2 || argv[1][0] == '-' || argv[1][0] == '/')
+        return std::nullopt;
+    auto subcommand = CLI::detail::to_lower(CLI::narrow(argv[1]));
+    if (subcommand == "serve" || subcommand == "batch" || subcommand == "watch")
+        return std::nullopt;
+
+    auto connection = hdr::ipc::Connect(server_endpoint);
+    if (!connection)
+        return std::nullopt;
+
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+        args.push_back(CLI::narrow(argv[i]));
+    auto command_line = make_command_line(args);
+    if (!command_line)
+        return std::nullopt;
+
+    // If the server went away, fall back to direct execution.
+    // Repeating an "on" or "off" command is harmless, as already switched displays are skipped.
+    auto result = hdr::SendCommand(*connection, *command_line);
+    if (!result)
+        return std::nullopt;
+    std::cout << result->output;
+    return result->exit_code;
 }
 
 int wmain(int argc, const wchar_t* const argv[])
 {
-    CLI::App app{"HDRCmd " VERSION_FULL " - turn \"Use HDR\" on or off from command line"};
+    // A running server already did the startup work below, so try it first
+    if (auto exit_code = forward_to_server(argc, argv))
+        return *exit_code;
+
+    CLI::App app;
+    setup_app(app);
+    subcommand::Serve::add(app);
+    subcommand::Batch::add(app);
+    subcommand::Watch::add(app);
 
-    // if Windows 10 < version 1803 refuse to start
-    if (!IsWindows10_1803OrGreater()) {
+    CLI11_PARSE(app, argc, argv);
+
+    // if Windows 10 < version 1803 refuse to start. Checked after parsing, so --help doesn't need it
+    if (!hdr::GetOsCapabilities().supported_os) {
         std::cerr << "Sorry, HDRCmd only works on Windows 10, version 1803 and above" << std::endl;
         return -2;
     }
-
-    app.allow_windows_style_options();
-    app.ignore_case();
-    app.require_subcommand(1);
-    app.failure_message(failure_message);
-
-    subcommand::Status::add(app);
-    subcommand::Enable::add(app);
-    subcommand::Disable::add(app);
-
-    CLI11_PARSE(app, argc, argv);
-    const auto* subcmd = app.get_subcommands()[0];
-    return static_cast<const subcommand::Base*>(subcmd)->run();
+    return run_command(app, std::cout);
 }
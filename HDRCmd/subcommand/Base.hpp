@@ -21,6 +21,8 @@
 
 #include "CLI/CLI.hpp"
 
+#include <ostream>
+
 namespace subcommand {
 class Base : public CLI::App
 {
@@ -31,8 +33,13 @@ protected:
     }
 
 public:
-    virtual int run() const = 0;
-
+    /// Execute the subcommand, writing output to \a out. Returns the exit code
+    virtual int run(std::ostream& out) const = 0;
+    /**
+     * Whether an exit code returned by run() means the command failed.
+     * Commands reporting a result through the exit code override this.
+     */
+    virtual bool is_failure(int exit_code) const { return exit_code != 0; }
 };
 
 } // namespace subcommand
@@ -0,0 +1,133 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Batch.hpp"
+
+#include "../Commands.hpp"
+#include "../DisplayChangeWatcher.hpp"
+#include "HDR.h"
+
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <print>
+#include <thread>
+
+namespace subcommand {
+
+Batch::Batch(CLI::App* parent)
+    : Base("Execute commands read from a file or standard input, one command per line", "batch", parent)
+{
+    add_option("file", file, "File to read commands from; \"-\" for standard input")->type_name("FILE");
+    add_flag("-k,--keep-going", keep_going, "Keep executing commands after a command failed");
+}
+
+static std::string_view trim(std::string_view str)
+{
+    auto begin = str.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos)
+        return {};
+    auto end = str.find_last_not_of(" \t\r");
+    return str.substr(begin, end - begin + 1);
+}
+
+/**
+ * Check for the "wait [SECONDS]" command, only available in batches.
+ * Returns the time to wait, or an empty optional if the line is not a wait command.
+ * Sets \a valid to \c false if the wait time could not be parsed.
+ */
+static std::optional<std::chrono::milliseconds> parse_wait(std::string_view line, bool& valid)
+{
+    valid = true;
+    auto word_end = line.find_first_of(" \t");
+    if (CLI::detail::to_lower(std::string(line.substr(0, word_end))) != "wait")
+        return std::nullopt;
+    if (word_end == std::string_view::npos)
+        return std::chrono::seconds(1);
+
+    auto arg = trim(line.substr(word_end));
+    double seconds = 0;
+    auto result = std::from_chars(arg.data(), arg.data() + arg.size(), seconds);
+    valid = result.ec == std::errc() && result.ptr == arg.data() + arg.size() && seconds >= 0;
+    return std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000));
+}
+
+int Batch::run_commands(std::istream& in, std::ostream& out) const
+{
+    int batch_exit_code = 0;
+    size_t line_num = 0;
+    std::string line_buf;
+    while (std::getline(in, line_buf)) {
+        line_num++;
+        auto line = trim(line_buf);
+        if (line.empty() || line.starts_with('#'))
+            continue;
+
+        int exit_code;
+        bool failed;
+        bool wait_valid;
+        if (auto wait_time = parse_wait(line, wait_valid)) {
+            if (wait_valid)
+                std::this_thread::sleep_for(*wait_time);
+            else
+                std::println(out, "Invalid wait time");
+            exit_code = wait_valid ? 0 : -1;
+            failed = !wait_valid;
+        } else {
+            // Other programs, or previous commands, may have changed the HDR mode in the meantime
+            hdr::InvalidateStatus();
+            exit_code = execute_command(std::string(line), out, failed);
+        }
+        std::println(out, "[{}] {}: {}", line_num, line, exit_code);
+        out.flush();
+
+        // Results like the status from "status --mode exitcode" don't stop the batch
+        if (failed) {
+            batch_exit_code = exit_code;
+            if (!keep_going)
+                break;
+        }
+    }
+    return batch_exit_code;
+}
+
+int Batch::run(std::ostream& out) const
+{
+    // Display configuration stays cached between commands, until the displays change
+    DisplayChangeWatcher watcher([]() { hdr::InvalidateTopology(); });
+
+    if (file == "-")
+        return run_commands(std::cin, out);
+
+    std::ifstream in(std::filesystem::path(CLI::widen(file)));
+    if (!in) {
+        std::println(out, "Could not open {}", file);
+        return -1;
+    }
+    return run_commands(in, out);
+}
+
+CLI::App* Batch::add(CLI::App& app)
+{
+    return app.add_subcommand(std::shared_ptr<Batch>(new Batch(&app)));
+}
+
+} // namespace subcommand
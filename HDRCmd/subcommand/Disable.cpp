@@ -18,18 +18,13 @@
 
 #include "Disable.hpp"
 
-#include "HDR.h"
-
 namespace subcommand {
 
-Disable::Disable(CLI::App* parent) : Base("Turn HDR off", "off", parent) { }
+Disable::Disable(CLI::App* parent) : SetStatus("Turn HDR off", "off", parent) { }
 
-int Disable::run() const
+int Disable::run(std::ostream& out) const
 {
-    auto result = hdr::SetWindowsHDRStatus(false);
-    if (!result)
-        return -1;
-    return *result == hdr::Status::Off ? 0 : 1;
+    return run_set_status(out, false);
 }
 
 CLI::App* Disable::add(CLI::App& app)
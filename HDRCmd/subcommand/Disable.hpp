@@ -19,16 +19,16 @@
 #ifndef SUBCOMMAND_DISABLE_HPP_
 #define SUBCOMMAND_DISABLE_HPP_
 
-#include "Base.hpp"
+#include "SetStatus.hpp"
 
 namespace subcommand {
-class Disable : public Base
+class Disable : public SetStatus
 {
 protected:
     Disable(CLI::App* parent);
 
 public:
-    int run() const override;
+    int run(std::ostream& out) const override;
 
     static CLI::App* add(CLI::App& app);
 };
@@ -0,0 +1,192 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DisplaySelector.hpp"
+
+#include "DisplayIndex.h"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <optional>
+#include <string_view>
+#include <variant>
+
+namespace subcommand {
+
+namespace {
+struct NameSelector
+{
+    std::wstring name;
+};
+using Selector = std::variant<size_t, hdr::TargetId, NameSelector>;
+} // anonymous namespace
+
+template<typename T> static bool parse_number(std::string_view str, T& value, int base = 10)
+{
+    auto result = std::from_chars(str.data(), str.data() + str.size(), value, base);
+    return result.ec == std::errc() && result.ptr == str.data() + str.size();
+}
+
+// Parse "<adapter LUID, 16 hex digits>:<target id>"
+static std::optional<hdr::TargetId> parse_id(std::string_view str)
+{
+    auto colon = str.find(':');
+    if (colon != 16)
+        return std::nullopt;
+
+    uint32_t high = 0;
+    hdr::TargetId id;
+    if (!parse_number(str.substr(0, 8), high, 16) || !parse_number(str.substr(8, 8), id.adapter.low, 16)
+        || !parse_number(str.substr(colon + 1), id.id))
+        return std::nullopt;
+    id.adapter.high = static_cast<int32_t>(high);
+    return id;
+}
+
+static std::optional<Selector> parse_selector(std::string_view str)
+{
+    if (str.starts_with("index:")) {
+        size_t index = 0;
+        if (!parse_number(str.substr(6), index))
+            return std::nullopt;
+        return index;
+    }
+    if (str.starts_with("id:")) {
+        auto id = parse_id(str.substr(3));
+        if (!id)
+            return std::nullopt;
+        return *id;
+    }
+    if (str.starts_with("name:")) {
+        if (str.size() == 5)
+            return std::nullopt;
+        return NameSelector { CLI::widen(std::string(str.substr(5))) };
+    }
+
+    // No prefix: guess from the form
+    size_t index = 0;
+    if (parse_number(str, index))
+        return index;
+    if (auto id = parse_id(str))
+        return *id;
+    if (str.empty())
+        return std::nullopt;
+    return NameSelector { CLI::widen(std::string(str)) };
+}
+
+std::string DisplaySelectorValidator::validate_func(std::string& item)
+{
+    if (parse_selector(item))
+        return {};
+    return std::format("\"{}\" is not a valid display index, id or name", item);
+}
+
+DisplaySelectorValidator::DisplaySelectorValidator() : Validator("DISPLAY", &validate_func) { }
+
+CLI::Option* add_display_option(CLI::App& app, std::vector<std::string>& selectors)
+{
+    auto option = app.add_option("-d,--display", selectors,
+                                 "Display to operate on: index, id or name (may be given multiple times)");
+    option->type_name("DISPLAY");
+    option->check(DisplaySelectorValidator());
+    return option;
+}
+
+std::string format_display_id(const hdr::TargetId& id)
+{
+    return std::format("{:08x}{:08x}:{}", static_cast<uint32_t>(id.adapter.high), id.adapter.low, id.id);
+}
+
+struct DisplaySelection::State
+{
+    std::vector<Selector> selectors;
+    hdr::DisplayIndex index;
+    /// Target ids of the selected displays, sorted
+    std::vector<hdr::TargetId> selected;
+};
+
+DisplaySelection::DisplaySelection(const std::vector<std::string>& selectors)
+{
+    if (selectors.empty())
+        return;
+
+    state = std::make_shared<State>();
+    state->selectors.reserve(selectors.size());
+    for (const auto& str : selectors) {
+        // Validation has already rejected malformed selectors
+        if (auto selector = parse_selector(str))
+            state->selectors.push_back(std::move(*selector));
+    }
+    update();
+}
+
+void DisplaySelection::update()
+{
+    if (!state || !state->index.Update())
+        return;
+
+    const auto& index = state->index;
+    auto& selected = state->selected;
+    selected.clear();
+    for (const auto& selector : state->selectors) {
+        if (const auto* display_index = std::get_if<size_t>(&selector)) {
+            if (const auto* display = index.FindByIndex(*display_index))
+                selected.push_back(display->id);
+        } else if (const auto* id = std::get_if<hdr::TargetId>(&selector)) {
+            if (const auto* display = index.FindById(*id))
+                selected.push_back(display->id);
+        } else if (const auto* name = std::get_if<NameSelector>(&selector)) {
+            for (const auto* display : index.FindByName(name->name))
+                selected.push_back(display->id);
+        }
+    }
+    std::ranges::sort(selected);
+    auto duplicates = std::ranges::unique(selected);
+    selected.erase(duplicates.begin(), duplicates.end());
+}
+
+hdr::DisplayFilter DisplaySelection::filter() const
+{
+    if (!state)
+        return {};
+
+    return [state = std::shared_ptr<const State>(state)](const hdr::DisplayRef& ref) {
+        return std::ranges::binary_search(state->selected, ref.id);
+    };
+}
+
+hdr::DisplayFilter make_display_filter(const std::vector<std::string>& selectors)
+{
+    return DisplaySelection(selectors).filter();
+}
+
+hdr::DisplayList get_displays(const hdr::DisplayFilter& filter, std::vector<size_t>& indices)
+{
+    indices.clear();
+    hdr::DisplayList list;
+    hdr::GetDisplays(list, [&](const hdr::DisplayRef& ref) {
+        if (filter && !filter(ref))
+            return false;
+        indices.push_back(ref.index);
+        return true;
+    });
+    return list;
+}
+
+} // namespace subcommand
@@ -0,0 +1,88 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBCOMMAND_DISPLAYSELECTOR_HPP_
+#define SUBCOMMAND_DISPLAYSELECTOR_HPP_
+
+#include "CLI/CLI.hpp"
+
+#include "DisplayList.h"
+#include "HDR.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace subcommand {
+/**
+ * Validator for display selectors. Accepted forms:
+ * - an index, as printed by "status --mode long" (optionally prefixed with "index:")
+ * - an adapter/target id, as printed by "status --mode long" (optionally prefixed with "id:")
+ * - a display name, compared case-insensitively (optionally prefixed with "name:")
+ */
+class DisplaySelectorValidator : public CLI::Validator
+{
+    static std::string validate_func(std::string& item);
+
+public:
+    DisplaySelectorValidator();
+};
+
+/// Add a repeatable "--display" option
+CLI::Option* add_display_option(CLI::App& app, std::vector<std::string>& selectors);
+
+/// Format a target id the way display selectors accept it
+std::string format_display_id(const hdr::TargetId& id);
+
+/**
+ * Displays selected by any of a number of selectors.
+ * Selectors are resolved to displays through a hdr::DisplayIndex. That happens on construction,
+ * and again on update() if the display topology changed.
+ */
+class DisplaySelection
+{
+    struct State;
+    std::shared_ptr<State> state;
+
+public:
+    explicit DisplaySelection(const std::vector<std::string>& selectors);
+
+    /// Resolve the selectors again if the display topology changed. Must not be called from the filter
+    void update();
+    /**
+     * Filter matching the selected displays; reflects later update() calls.
+     * Returns an empty filter (selecting all displays) if no selectors were given.
+     */
+    hdr::DisplayFilter filter() const;
+};
+
+/**
+ * Build a filter matching displays selected by any of the given selectors, as they are now.
+ * Returns an empty filter (selecting all displays) if no selectors are given.
+ */
+hdr::DisplayFilter make_display_filter(const std::vector<std::string>& selectors);
+
+/**
+ * Get displays matching a filter.
+ * \param indices Receives the index of each display in the unfiltered display list, for use as a selector.
+ */
+hdr::DisplayList get_displays(const hdr::DisplayFilter& filter, std::vector<size_t>& indices);
+
+} // namespace subcommand
+
+#endif // SUBCOMMAND_DISPLAYSELECTOR_HPP_
@@ -18,18 +18,13 @@
 
 #include "Enable.hpp"
 
-#include "HDR.h"
-
 namespace subcommand {
 
-Enable::Enable(CLI::App* parent) : Base("Turn HDR on", "on", parent) { }
+Enable::Enable(CLI::App* parent) : SetStatus("Turn HDR on", "on", parent) { }
 
-int Enable::run() const
+int Enable::run(std::ostream& out) const
 {
-    auto result = hdr::SetWindowsHDRStatus(true);
-    if (!result)
-        return -1;
-    return *result == hdr::Status::On ? 0 : 1;
+    return run_set_status(out, true);
 }
 
 CLI::App* Enable::add(CLI::App& app)
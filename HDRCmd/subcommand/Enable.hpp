@@ -19,16 +19,16 @@
 #ifndef SUBCOMMAND_ENABLE_HPP_
 #define SUBCOMMAND_ENABLE_HPP_
 
-#include "Base.hpp"
+#include "SetStatus.hpp"
 
 namespace subcommand {
-class Enable : public Base
+class Enable : public SetStatus
 {
 protected:
     Enable(CLI::App* parent);
 
 public:
-    int run() const override;
+    int run(std::ostream& out) const override;
 
     static CLI::App* add(CLI::App& app);
 };
@@ -0,0 +1,53 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "List.hpp"
+
+#include "DisplaySelector.hpp"
+#include "Status.hpp"
+
+#include <print>
+
+namespace subcommand {
+
+List::List(CLI::App* parent)
+    : Base("List displays: one line per display, with index, id, status and name", "list", parent)
+{
+    add_display_option(*this, displays);
+}
+
+int List::run(std::ostream& out) const
+{
+    std::vector<size_t> indices;
+    auto display_list = get_displays(make_display_filter(displays), indices);
+
+    auto entries = display_list.GetDisplays();
+    for (size_t i = 0; i < entries.size(); i++) {
+        const auto& disp = entries[i];
+        std::println(out, "{}\t{}\t{}\t{}", indices[i], format_display_id(disp.id), Status::status_string(disp.status),
+                     disp.name_utf8);
+    }
+    return 0;
+}
+
+CLI::App* List::add(CLI::App& app)
+{
+    return app.add_subcommand(std::shared_ptr<List>(new List(&app)));
+}
+
+} // namespace subcommand
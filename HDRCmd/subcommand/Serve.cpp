@@ -0,0 +1,92 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Serve.hpp"
+
+#include "../Commands.hpp"
+#include "../DisplayChangeWatcher.hpp"
+#include "CommandServer.h"
+#include "HDR.h"
+#include "Trace.h"
+
+#include <print>
+#include <sstream>
+
+namespace subcommand {
+
+Serve::Serve(CLI::App* parent) : Base("Run a server executing commands from other HDRCmd invocations", "serve", parent)
+{
+    add_flag("--stop", stop, "Stop a running server");
+    add_flag("--trace", trace, "Trace display configuration calls; see \"stats\" command");
+}
+
+static int stop_server(std::ostream& out)
+{
+    auto connection = hdr::ipc::Connect(server_endpoint);
+    if (!connection) {
+        std::println(out, "No server is running");
+        return 1;
+    }
+    if (!hdr::SendCommand(*connection, hdr::shutdown_command)) {
+        std::println(out, "Failed to stop server");
+        return 1;
+    }
+    std::println(out, "Server stopped");
+    return 0;
+}
+
+static hdr::CommandResult execute_request(std::string_view command)
+{
+    // HDR mode can be changed by other programs without a display change notification
+    hdr::InvalidateStatus();
+
+    std::ostringstream output;
+    hdr::CommandResult result;
+    result.exit_code = execute_command(std::string(command), output);
+    result.output = std::move(output).str();
+    return result;
+}
+
+int Serve::run(std::ostream& out) const
+{
+    if (stop)
+        return stop_server(out);
+
+    auto listener = hdr::ipc::Listen(server_endpoint);
+    if (!listener) {
+        std::println(out, "A server is already running");
+        return 1;
+    }
+
+    hdr::trace::SetEnabled(trace);
+
+    // Display configuration stays cached between requests, until the displays change
+    DisplayChangeWatcher watcher([]() { hdr::InvalidateTopology(); });
+    std::println(out, "Serving requests, stop with \"HDRCmd serve --stop\"");
+    out.flush();
+
+    hdr::ServeCommands(*listener, server_endpoint, &execute_request);
+    return 0;
+}
+
+CLI::App* Serve::add(CLI::App& app)
+{
+    return app.add_subcommand(std::shared_ptr<Serve>(new Serve(&app)));
+}
+
+} // namespace subcommand
@@ -0,0 +1,116 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "SetStatus.hpp"
+
+#include "DisplaySelector.hpp"
+#include "Status.hpp"
+
+#include "HDR.h"
+#include "SwitchCoalescer.h"
+
+#include <optional>
+#include <print>
+
+namespace subcommand {
+
+SetStatus::SetStatus(std::string description, std::string name, CLI::App* parent)
+    : Base(std::move(description), std::move(name), parent)
+{
+    add_flag("-p,--parallel", parallel, "Switch displays on different adapters concurrently");
+    add_flag("-n,--dry-run", dry_run, "Only print which displays would be switched");
+    add_display_option(*this, displays);
+}
+
+static void print_plan(std::ostream& out, const hdr::ReconcileResult& result)
+{
+    for (const auto& step : result.steps) {
+        auto name = CLI::narrow(step.display.name);
+        switch (step.action) {
+        case hdr::ReconcileStep::Action::Skip:
+            std::println(out, "{}: skip", name);
+            break;
+        case hdr::ReconcileStep::Action::Switch:
+            std::println(out, "{}: switch {}", name, step.enable ? "on" : "off");
+            break;
+        case hdr::ReconcileStep::Action::Unsupported:
+            std::println(out, "{}: unsupported", name);
+            break;
+        }
+    }
+}
+
+/* Switch all displays through the process-wide coalescer. When serving, requests from concurrent
+ * HDRCmd invocations meet there: they are merged into one switch to the last requested state, and
+ * switches are spaced, as switching right after a previous switch may catch the driver still settling.
+ * The merged switch is performed in the switch mode of the request that happens to perform it.
+ * Returns the result if this request performed the switch, or nothing if another request did */
+static std::optional<hdr::ReconcileResult> switch_coalesced(bool enable, hdr::SwitchMode mode)
+{
+    using Request = hdr::SwitchCoalescer::Request;
+    auto& coalescer = hdr::GetSwitchCoalescer();
+    auto ticket = coalescer.Add(enable ? Request::Enable : Request::Disable);
+    std::optional<hdr::ReconcileResult> result;
+    while (auto request = coalescer.WaitDone(ticket)) {
+        // HDRCmd only adds "enable" and "disable" requests, so the merged request is one of these
+        result = hdr::ReconcileHDRStatus(*request == Request::Enable, false, {}, mode);
+        coalescer.EndSwitch();
+    }
+    return result;
+}
+
+int SetStatus::run_set_status(std::ostream& out, bool enable) const
+{
+    auto mode = parallel ? hdr::SwitchMode::Parallel : hdr::SwitchMode::Sequential;
+    // Requests for selected displays can't be merged with others
+    if (!dry_run && displays.empty()) {
+        if (auto result = switch_coalesced(enable, mode))
+            return print_result(out, *result, enable);
+
+        auto status = hdr::GetWindowsHDRStatus();
+        std::println(out, "Combined with other requests, HDR is now {}", Status::status_string(status));
+        return status == (enable ? hdr::Status::On : hdr::Status::Off) ? 0 : 1;
+    }
+
+    auto result = hdr::ReconcileHDRStatus(enable, dry_run, make_display_filter(displays), mode);
+    if (result.steps.empty() && !displays.empty()) {
+        out << "No display matches the given selection" << std::endl;
+        return -1;
+    }
+
+    return print_result(out, result, enable);
+}
+
+int SetStatus::print_result(std::ostream& out, const hdr::ReconcileResult& result, bool enable) const
+{
+    if (dry_run) {
+        print_plan(out, result);
+        std::println(out, "Would switch {} display(s), skip {}", result.num_switched, result.num_skipped);
+    } else if (result.num_failed > 0) {
+        std::println(out, "Switched {} display(s), skipped {}, failed {}", result.num_switched, result.num_skipped,
+                     result.num_failed);
+    } else {
+        std::println(out, "Switched {} display(s), skipped {}", result.num_switched, result.num_skipped);
+    }
+
+    if (!result.status)
+        return -1;
+    return *result.status == (enable ? hdr::Status::On : hdr::Status::Off) ? 0 : 1;
+}
+
+} // namespace subcommand
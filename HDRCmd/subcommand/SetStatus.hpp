@@ -0,0 +1,50 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBCOMMAND_SETSTATUS_HPP_
+#define SUBCOMMAND_SETSTATUS_HPP_
+
+#include "Base.hpp"
+
+#include "HDR.h"
+
+#include <string>
+#include <vector>
+
+namespace subcommand {
+/// Common base for subcommands changing the HDR status
+class SetStatus : public Base
+{
+protected:
+    bool parallel = false;
+    bool dry_run = false;
+    std::vector<std::string> displays;
+
+    SetStatus(std::string description, std::string name, CLI::App* parent);
+
+    /// Bring displays into the given state, print a summary and return the exit code
+    int run_set_status(std::ostream& out, bool enable) const;
+
+private:
+    /// Print a summary of switching displays and return the exit code
+    int print_result(std::ostream& out, const hdr::ReconcileResult& result, bool enable) const;
+};
+
+} // namespace subcommand
+
+#endif // SUBCOMMAND_SETSTATUS_HPP_
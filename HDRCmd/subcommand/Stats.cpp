@@ -0,0 +1,72 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Stats.hpp"
+
+#include "SwitchCoalescer.h"
+#include "Trace.h"
+
+#include <format>
+
+namespace subcommand {
+
+Stats::Stats(CLI::App* parent) : Base("Print statistics on display configuration calls and switches", "stats", parent)
+{
+    auto format_option = add_option("-f,--format", format, "Output format");
+    format_option->type_name("FORMAT");
+    format_option->transform(CLI::IsMember({ "text", "json" }, CLI::ignore_case));
+    add_flag("--reset", reset, "Discard collected statistics after printing");
+}
+
+int Stats::run(std::ostream& out) const
+{
+    auto spans = hdr::trace::GetSpanStats();
+    auto switch_stats = hdr::GetSwitchCoalescer().GetStats();
+
+    // Build output in one go, so it's written at once
+    std::string output;
+    if (format == "json") {
+        output = std::format("{{\"tracing\":{},\"switches\":{{\"requests\":{},\"coalesced\":{},\"executed\":{}}},"
+                             "\"spans\":",
+                             hdr::trace::IsEnabled(), switch_stats.requests, switch_stats.coalesced,
+                             switch_stats.executed);
+        auto spans_json = hdr::trace::FormatJson(spans);
+        // Strip trailing newline
+        spans_json.pop_back();
+        output.append(spans_json);
+        output.append("}\n");
+    } else {
+        output = std::format("Switch requests: {}, coalesced: {}, executed: {}\n\n", switch_stats.requests,
+                             switch_stats.coalesced, switch_stats.executed);
+        output.append(hdr::trace::FormatText(spans));
+    }
+    out << output;
+
+    if (reset) {
+        hdr::trace::Reset();
+        hdr::GetSwitchCoalescer().ResetStats();
+    }
+    return 0;
+}
+
+CLI::App* Stats::add(CLI::App& app)
+{
+    return app.add_subcommand(std::shared_ptr<Stats>(new Stats(&app)));
+}
+
+} // namespace subcommand
@@ -0,0 +1,47 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBCOMMAND_STATS_HPP_
+#define SUBCOMMAND_STATS_HPP_
+
+#include "Base.hpp"
+
+#include <string>
+
+namespace subcommand {
+/**
+ * Print collected statistics: traced display configuration calls and switch requests.
+ * Mostly useful with a server started with "serve --trace", which keeps collecting over time.
+ */
+class Stats : public Base
+{
+protected:
+    std::string format = "text";
+    bool reset = false;
+
+    Stats(CLI::App* parent);
+
+public:
+    int run(std::ostream& out) const override;
+
+    static CLI::App* add(CLI::App& app);
+};
+
+} // namespace subcommand
+
+#endif // SUBCOMMAND_STATS_HPP_
@@ -18,11 +18,12 @@
 
 #include "Status.hpp"
 
-#include "HDR.h"
+#include "DisplaySelector.hpp"
 
+#include <algorithm>
 #include <array>
 #include <format>
-#include <print>
+#include <iterator>
 
 namespace subcommand {
 
@@ -53,14 +54,34 @@ public:
     StatusModeValidator() : Validator(descr_string, &validate_func) { }
 };
 
+class StatusFormatValidator : public CLI::Validator
+{
+    static constexpr const char* descr_string = "json,ndjson,tsv";
+
+    static std::string validate_func(std::string& item)
+    {
+        item = CLI::detail::to_lower(item);
+        if (item == "json" || item == "ndjson" || item == "tsv")
+            return {};
+        return std::format("\"{}\" not in {}", item, descr_string);
+    }
+
+public:
+    StatusFormatValidator() : Validator(descr_string, &validate_func) { }
+};
+
 Status::Status(CLI::App* parent) : Base("Print current HDR status", "status", parent)
 {
     auto mode_option = add_option("-m,--mode", mode, "How to report status mode");
     mode_option->type_name("MODE");
     mode_option->transform(StatusModeValidator());
+    auto format_option = add_option("-f,--format", format, "Print per-display records in a machine-readable format");
+    format_option->type_name("FORMAT");
+    format_option->transform(StatusFormatValidator());
+    add_display_option(*this, displays);
 }
 
-static std::string_view status_string(hdr::Status status)
+std::string_view Status::status_string(hdr::Status status)
 {
     switch (status) {
     case hdr::Status::Off:
@@ -73,79 +94,242 @@ static std::string_view status_string(hdr::Status status)
     return "???";
 }
 
-void Status::print_status_short()
+std::string_view Status::api_string(hdr::ApiGeneration api)
 {
-    auto status = hdr::GetWindowsHDRStatus();
-    std::println("HDR is {}", status_string(status));
+    switch (api) {
+    case hdr::ApiGeneration::Unknown:
+        return "unknown";
+    case hdr::ApiGeneration::Legacy:
+        return "legacy";
+    case hdr::ApiGeneration::Win11_24H2:
+        return "win11_24h2";
+    }
+    return "???";
 }
 
-void Status::print_status_long()
+namespace {
+/// Per-display output, with strings already converted to UTF-8
+struct DisplayRecord
 {
-    auto displays = hdr::GetDisplays();
+    size_t index;
+    /// Name, pointing into the display list the record was made from
+    std::string_view name;
+    std::string id;
+    std::string_view status;
+    std::string_view api;
+    /// Clone group number, starting at 1; empty if the display is not a clone
+    std::string clone_group;
+};
+} // anonymous namespace
+
+static std::vector<DisplayRecord> get_records(const hdr::DisplayFilter& filter, hdr::DisplayList& display_list)
+{
+    // Keep the indices from the unfiltered list, so they can be used as selectors
+    std::vector<size_t> indices;
+    display_list = get_displays(filter, indices);
+    auto displays = display_list.GetDisplays();
+
+    std::vector<DisplayRecord> records;
+    records.reserve(displays.size());
+    for (size_t i = 0; i < displays.size(); i++) {
+        const auto& disp = displays[i];
+        std::string clone_group = disp.clone_group ? std::to_string(*disp.clone_group + 1) : std::string();
+        records.push_back({ indices[i], disp.name_utf8, format_display_id(disp.id),
+                            Status::status_string(disp.status), Status::api_string(disp.api), std::move(clone_group) });
+    }
+    return records;
+}
+
+// Number of characters (code points) in a UTF-8 string
+static size_t utf8_length(std::string_view str)
+{
+    return std::ranges::count_if(str, [](char c) { return (static_cast<unsigned char>(c) & 0xc0) != 0x80; });
+}
+
+// Append a string padded to the given width, measured in characters
+static void append_padded(std::string& output, std::string_view str, size_t width, bool right_align = false)
+{
+    auto padding = width - std::min(width, utf8_length(str));
+    if (right_align)
+        output.append(padding, ' ');
+    output.append(str);
+    if (!right_align)
+        output.append(padding, ' ');
+}
+
+void Status::render_status_short(std::string& output, hdr::Status status)
+{
+    std::format_to(std::back_inserter(output), "HDR is {}\n", status_string(status));
+}
+
+void Status::render_status_long(std::string& output, const hdr::DisplayFilter& filter)
+{
+    hdr::DisplayList display_list;
+    auto records = get_records(filter, display_list);
 
     // Tabulate.
-    // Columns: #, Display name, Status
-    static constexpr size_t num_cols = 3;
-    static constexpr std::string_view col_headings[num_cols] = { "Display #", "Name", "Status" };
+    // Columns: #, Display name, Id, Status, Clone group
+    static constexpr size_t num_cols = 5;
+    static constexpr std::string_view col_headings[num_cols] = { "Display #", "Name", "Id", "Status", "Clone" };
+    std::vector<std::array<std::string, num_cols>> rows;
+    rows.reserve(records.size());
+    for (const auto& record : records) {
+        auto clone_group = record.clone_group.empty() ? std::string("-") : record.clone_group;
+        rows.push_back({ std::to_string(record.index), std::string(record.name), record.id, std::string(record.status),
+                         std::move(clone_group) });
+    }
+
     std::array<size_t, num_cols> widths;
-    widths[0] = std::max(size_t(ceil(log10(displays.size() + 1))) + 1, col_headings[0].size());
-    widths[1] = col_headings[1].size();
-    widths[2] = col_headings[2].size();
-    for(const auto& disp : displays)
+    for (size_t i = 0; i < num_cols; i++)
     {
-        widths[1] = std::max(widths[1], disp.name.size());
-        widths[2] = std::max(widths[2], status_string(disp.status).size());
+        widths[i] = col_headings[i].size();
+        for (const auto& row : rows)
+            widths[i] = std::max(widths[i], utf8_length(row[i]));
     }
 
-    // Print heading
+    // Heading
     for (size_t i = 0; i < num_cols; i++)
     {
         if (i > 0)
-            std::cout << "\t";
-        std::print("{:<{}}", col_headings[i], widths[i]);
+            output.push_back('\t');
+        append_padded(output, col_headings[i], widths[i]);
     }
-    std::cout << std::endl;
+    output.push_back('\n');
     for (size_t i = 0; i < num_cols; i++)
     {
         if (i > 0)
-            std::cout << "\t";
-        std::print("{:-<{}}", "", widths[i]);
+            output.push_back('\t');
+        output.append(widths[i], '-');
     }
-    std::cout << std::endl;
-    for (size_t i = 0; i < displays.size(); i++)
+    output.push_back('\n');
+    // Rows; display number is right-aligned
+    for (const auto& row : rows)
     {
-        const auto& disp = displays[i];
-        std::println("{:>{}}\t{:<{}}\t{:<{}}", i, widths[0], CLI::narrow(disp.name), widths[1],
-                     status_string(disp.status), widths[2]);
+        for (size_t i = 0; i < num_cols; i++)
+        {
+            if (i > 0)
+                output.push_back('\t');
+            append_padded(output, row[i], widths[i], i == 0);
+        }
+        output.push_back('\n');
     }
 }
 
-int Status::run() const
+// Append a string as JSON string literal
+static void append_json_string(std::string& output, std::string_view str)
 {
-    if (mode.empty() || stricmp(mode.c_str(), "short") == 0) {
-        print_status_short();
-        return 0;
-    } else if (stricmp(mode.c_str(), "long") == 0) {
-        print_status_short();
-        std::cout << std::endl;
-        print_status_long();
-        return 0;
-    } else if (stricmp(mode.c_str(), "exitcode") == 0) {
-        auto status = hdr::GetWindowsHDRStatus();
-        switch(status)
-        {
-        case hdr::Status::On:
-            return 0;
-        case hdr::Status::Off:
-            return 1;
-        case hdr::Status::Unsupported:
-            return 2;
+    output.push_back('"');
+    for (char c : str) {
+        switch (c) {
+        case '"':
+            output.append("\\\"");
+            break;
+        case '\\':
+            output.append("\\\\");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                std::format_to(std::back_inserter(output), "\\u{:04x}", c);
+            else
+                output.push_back(c);
+            break;
+        }
+    }
+    output.push_back('"');
+}
+
+static void append_json_record(std::string& output, const DisplayRecord& record)
+{
+    std::format_to(std::back_inserter(output), "{{\"index\":{},\"name\":", record.index);
+    append_json_string(output, record.name);
+    std::format_to(std::back_inserter(output), ",\"id\":\"{}\",\"status\":\"{}\",\"api\":\"{}\",\"clone_group\":{}}}",
+                   record.id, record.status, record.api,
+                   record.clone_group.empty() ? std::string_view("null") : std::string_view(record.clone_group));
+}
+
+// Replace characters that would break the TSV structure
+static std::string tsv_field(std::string_view str)
+{
+    std::string field(str);
+    std::ranges::replace_if(field, [](char c) { return c == '\t' || c == '\r' || c == '\n'; }, ' ');
+    return field;
+}
+
+void Status::render_records(std::string& output, std::string_view format, hdr::Status status,
+                            const hdr::DisplayFilter& filter)
+{
+    hdr::DisplayList display_list;
+    auto records = get_records(filter, display_list);
+    if (format == "json") {
+        std::format_to(std::back_inserter(output), "{{\"status\":\"{}\",\"displays\":[", status_string(status));
+        for (size_t i = 0; i < records.size(); i++) {
+            if (i > 0)
+                output.push_back(',');
+            append_json_record(output, records[i]);
+        }
+        output.append("]}\n");
+    } else if (format == "ndjson") {
+        for (const auto& record : records) {
+            append_json_record(output, record);
+            output.push_back('\n');
         }
+    } else if (format == "tsv") {
+        output.append("index\tname\tid\tstatus\tapi\tclone_group\n");
+        for (const auto& record : records) {
+            std::format_to(std::back_inserter(output), "{}\t{}\t{}\t{}\t{}\t{}\n", record.index,
+                           tsv_field(record.name), record.id, record.status, record.api, record.clone_group);
+        }
+    }
+}
+
+static int status_exit_code(hdr::Status status)
+{
+    switch(status)
+    {
+    case hdr::Status::On:
+        return 0;
+    case hdr::Status::Off:
+        return 1;
+    case hdr::Status::Unsupported:
+        return 2;
     }
-    // Validation should've caught other cases...
     return -1;
 }
 
+int Status::run(std::ostream& out) const
+{
+    auto filter = make_display_filter(displays);
+    auto status = hdr::GetWindowsHDRStatus(filter);
+    bool exitcode_mode = stricmp(mode.c_str(), "exitcode") == 0;
+
+    // Render everything into one buffer, and write that at once
+    std::string output;
+    if (!format.empty()) {
+        render_records(output, format, status, filter);
+    } else if (mode.empty() || stricmp(mode.c_str(), "short") == 0) {
+        render_status_short(output, status);
+    } else if (stricmp(mode.c_str(), "long") == 0) {
+        render_status_short(output, status);
+        output.push_back('\n');
+        render_status_long(output, filter);
+    } else if (!exitcode_mode) {
+        // Validation should've caught other cases...
+        return -1;
+    }
+    out.write(output.data(), static_cast<std::streamsize>(output.size()));
+    out.flush();
+
+    return exitcode_mode ? status_exit_code(status) : 0;
+}
+
+bool Status::is_failure(int exit_code) const
+{
+    // In exitcode mode, nonnegative exit codes are the status
+    if (stricmp(mode.c_str(), "exitcode") == 0)
+        return exit_code < 0;
+    return exit_code != 0;
+}
+
 CLI::App* Status::add(CLI::App& app)
 {
     return app.add_subcommand(std::shared_ptr<Status>(new Status(&app)));
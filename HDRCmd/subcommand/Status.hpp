@@ -21,19 +21,35 @@
 
 #include "Base.hpp"
 
+#include "HDR.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace subcommand {
 class Status : public Base
 {
-    static void print_status_short();
-    static void print_status_long();
+    static void render_status_short(std::string& output, hdr::Status status);
+    static void render_status_long(std::string& output, const hdr::DisplayFilter& filter);
+    static void render_records(std::string& output, std::string_view format, hdr::Status status,
+                               const hdr::DisplayFilter& filter);
 
 protected:
     std::string mode;
+    std::string format;
+    std::vector<std::string> displays;
 
     Status(CLI::App* parent);
 
 public:
-    int run() const override;
+    int run(std::ostream& out) const override;
+    bool is_failure(int exit_code) const override;
+
+    /// Get a printable string for a status
+    static std::string_view status_string(hdr::Status status);
+    /// Get a printable string for an API generation
+    static std::string_view api_string(hdr::ApiGeneration api);
 
     static CLI::App* add(CLI::App& app);
 };
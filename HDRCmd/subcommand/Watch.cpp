@@ -0,0 +1,141 @@
+/*
+    HDRCmd - enable/disable "Use HDR" from command line
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Watch.hpp"
+
+#include "../DisplayChangeWatcher.hpp"
+#include "DisplaySelector.hpp"
+#include "Status.hpp"
+#include "StatusWatcher.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <print>
+#include <utility>
+
+namespace subcommand {
+
+Watch::Watch(CLI::App* parent) : Base("Print HDR status changes as they happen, until interrupted", "watch", parent)
+{
+    add_display_option(*this, displays);
+}
+
+static std::string_view transition_status_string(const std::optional<hdr::Status>& status)
+{
+    // Display added or removed
+    if (!status)
+        return "-";
+    return Status::status_string(*status);
+}
+
+namespace {
+/// Maps time points of a hdr::Clock to wall clock time
+struct WallClockMapping
+{
+    hdr::Clock::time_point clock_base;
+    std::chrono::system_clock::time_point wall_base;
+
+    std::chrono::system_clock::time_point to_wall_clock(hdr::Clock::time_point time) const
+    {
+        return wall_base + std::chrono::duration_cast<std::chrono::system_clock::duration>(time - clock_base);
+    }
+};
+} // anonymous namespace
+
+static void print_transition(std::ostream& out, const hdr::StatusTransition& transition,
+                             const WallClockMapping& wall_clock)
+{
+    auto time = std::chrono::floor<std::chrono::milliseconds>(wall_clock.to_wall_clock(transition.time));
+    std::println(out, "{:%FT%TZ}\t{}\t{}\t{}\t{}", time, format_display_id(transition.id),
+                 transition_status_string(transition.old_status), transition_status_string(transition.new_status),
+                 CLI::narrow(transition.name));
+}
+
+namespace {
+/// Wakes up the main thread upon display changes or Ctrl+C
+struct WatchEvents
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool changed = false;
+    bool stop = false;
+};
+} // anonymous namespace
+
+static WatchEvents* current_events;
+
+static BOOL WINAPI console_ctrl_handler(DWORD)
+{
+    std::lock_guard lock(current_events->mutex);
+    current_events->stop = true;
+    current_events->cond.notify_one();
+    return TRUE;
+}
+
+int Watch::run(std::ostream& out) const
+{
+    WatchEvents events;
+    const auto& clock = hdr::SteadyClock::Get();
+    WallClockMapping wall_clock { clock.Now(), std::chrono::system_clock::now() };
+    // Keep the selection up to date, so displays plugged in later are watched as well
+    DisplaySelection selection(displays);
+    hdr::StatusWatcher status_watcher(clock, selection.filter());
+    DisplayChangeWatcher change_watcher([&events]() {
+        std::lock_guard lock(events.mutex);
+        events.changed = true;
+        events.cond.notify_one();
+    });
+    current_events = &events;
+    SetConsoleCtrlHandler(&console_ctrl_handler, TRUE);
+
+    std::unique_lock lock(events.mutex);
+    while (!events.stop) {
+        auto wait_time = status_watcher.TimeUntilNextCheck();
+        auto woken = [&]() { return events.changed || events.stop; };
+        if (wait_time)
+            events.cond.wait_for(lock, *wait_time, woken);
+        else
+            events.cond.wait(lock, woken);
+        if (events.stop)
+            break;
+
+        bool changed = std::exchange(events.changed, false);
+        lock.unlock();
+        if (changed)
+            status_watcher.NotifyChange();
+        selection.update();
+        for (const auto& transition : status_watcher.Poll())
+            print_transition(out, transition, wall_clock);
+        out.flush();
+        lock.lock();
+    }
+    lock.unlock();
+
+    SetConsoleCtrlHandler(&console_ctrl_handler, FALSE);
+    current_events = nullptr;
+    return 0;
+}
+
+CLI::App* Watch::add(CLI::App& app)
+{
+    return app.add_subcommand(std::shared_ptr<Watch>(new Watch(&app)));
+}
+
+} // namespace subcommand
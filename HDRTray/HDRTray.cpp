@@ -21,8 +21,12 @@
 #include "HDR.h"
 #include "l10n.h"
 #include "NotifyIcon.hpp"
-#include "WinVerCheck.hpp"
+#include "OsCapabilities.h"
+#include "RecheckScheduler.h"
+#include "Trace.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <utility>
 
@@ -38,6 +42,28 @@ ATOM                MyRegisterClass(HINSTANCE hInstance);
 BOOL                InitInstance(HINSTANCE, int);
 LRESULT CALLBACK    WndProc(HWND, UINT, WPARAM, LPARAM);
 
+// Check for an option given on the command line as "--name" or "/name"
+static bool HasCommandLineOption(const wchar_t* name)
+{
+    int argc = 0;
+    wchar_t** argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv)
+        return false;
+    bool found = false;
+    for (int i = 1; i < argc && !found; i++) {
+        const wchar_t* arg = argv[i];
+        if (arg[0] == '-' && arg[1] == '-')
+            arg += 2;
+        else if (arg[0] == '/')
+            arg += 1;
+        else
+            continue;
+        found = _wcsicmp(arg, name) == 0;
+    }
+    LocalFree(argv);
+    return found;
+}
+
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
                      _In_opt_ HINSTANCE hPrevInstance,
                      _In_ LPWSTR    lpCmdLine,
@@ -46,7 +72,8 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     UNREFERENCED_PARAMETER(hPrevInstance);
     UNREFERENCED_PARAMETER(lpCmdLine);
 
-    if(IsWindows10_1709OrGreater())
+    const auto& os_caps = hdr::GetOsCapabilities();
+    if(os_caps.per_monitor_dpi_v2)
         SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
     else
         SetProcessDPIAware();
@@ -55,12 +82,15 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance,
     l10n::LoadString(IDS_APP_TITLE, szTitle);
 
     // if Windows 10 < version 1803 refuse to start
-    if (!IsWindows10_1803OrGreater()) {
+    if (!os_caps.supported_os) {
         auto message = std::wstring(l10n::LoadString(IDS_WINDOWS_TOO_OLD));
         MessageBoxW(nullptr, message.c_str(), szTitle, MB_OK | MB_ICONERROR);
         return 1;
     }
 
+    // Tracing is off unless asked for, like HDRCmd's "serve --trace"
+    hdr::trace::SetEnabled(HasCommandLineOption(L"trace"));
+
     MyRegisterClass(hInstance);
 
     // Perform application initialization:
@@ -133,9 +163,33 @@ BOOL InitInstance(HINSTANCE hInstance, int nCmdShow)
 
 static std::unique_ptr<NotifyIcon> notify_icon;
 static UINT msg_TaskbarCreated;
-static unsigned hdr_status_check_count;
+/* HDR status doesn't seem to be always immediately up-to-date when receiving
+ * WM_DISPLAYCHANGE, so re-check it over a short duration */
+static hdr::RecheckScheduler recheck_scheduler;
 
-enum { TIMER_ID_WAIT_TASKBAR_CREATED = 1, TIMER_ID_RECHECK_HDR_STATUS = 2 };
+enum { TIMER_ID_WAIT_TASKBAR_CREATED = 1, TIMER_ID_RECHECK_HDR_STATUS = 2, TIMER_ID_UPDATE_DARK_MODE = 3 };
+/* Setting changes tend to arrive in bursts (e.g. during login),
+ * so wait for a burst to end before evaluating dark mode */
+static constexpr UINT dark_mode_debounce_ms = 200;
+
+// Perform a HDR status check if one is due, then arrange for the next one
+static void RecheckHDRStatus(HWND hWnd)
+{
+    if (recheck_scheduler.CheckDue()) {
+        // Status may have changed since the last check, even if the topology didn't.
+        // Topology changes come with WM_DISPLAYCHANGE, which invalidates the topology itself
+        hdr::InvalidateStatus();
+        recheck_scheduler.CheckDone(notify_icon->UpdateHDRStatus());
+    }
+
+    auto next_check = recheck_scheduler.TimeUntilNextCheck();
+    if (next_check) {
+        auto delay_ms = std::chrono::ceil<std::chrono::milliseconds>(*next_check).count();
+        SetTimer(hWnd, TIMER_ID_RECHECK_HDR_STATUS, std::max<UINT>(static_cast<UINT>(delay_ms), USER_TIMER_MINIMUM), nullptr);
+    } else {
+        KillTimer(hWnd, TIMER_ID_RECHECK_HDR_STATUS);
+    }
+}
 
 static void HandleTimer(HWND hWnd, int id)
 {
@@ -148,12 +202,12 @@ static void HandleTimer(HWND hWnd, int id)
             DestroyWindow(hWnd);
         break;
     case TIMER_ID_RECHECK_HDR_STATUS:
-        if (hdr_status_check_count > 0) {
-            hdr_status_check_count--;
-            if (notify_icon->UpdateHDRStatus())
-                hdr_status_check_count = 0;
-        } else
-            KillTimer(hWnd, TIMER_ID_RECHECK_HDR_STATUS);
+        RecheckHDRStatus(hWnd);
+        break;
+    case TIMER_ID_UPDATE_DARK_MODE:
+        KillTimer(hWnd, TIMER_ID_UPDATE_DARK_MODE);
+        notify_icon->UpdateDarkMode();
+        break;
     }
 }
 
@@ -192,6 +246,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
             case IDM_AUTOSTART:
                 notify_icon->ToggleAutostartEnabled();
                 break;
+            case IDM_STATISTICS:
+                notify_icon->ShowStatistics();
+                break;
             case IDM_EXIT:
                 DestroyWindow(hWnd);
                 break;
@@ -203,16 +260,18 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     case WM_DISPLAYCHANGE:
         // Position window at (0,0) so it's always on the primary monitor
         SetWindowPos(hWnd, nullptr, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
-        if (!notify_icon->UpdateHDRStatus())
-        {
-            /* HDR status doesn't seem to be always immediately up-to-date when receiving
-             * WM_DISPLAYCHANGE, so periodically re-check it over a short duration */
-            hdr_status_check_count = 10;
-            SetTimer(hWnd, TIMER_ID_RECHECK_HDR_STATUS, 500, nullptr);
-        }
+        hdr::InvalidateTopology();
+        recheck_scheduler.NotifyChange();
+        RecheckHDRStatus(hWnd);
         break;
     case WM_SETTINGCHANGE:
-        notify_icon->UpdateDarkMode();
+        // Re-arming the timer postpones the update until the burst is over
+        if (notify_icon->IsDarkModeSettingChange(reinterpret_cast<const wchar_t*>(lParam)))
+            SetTimer(hWnd, TIMER_ID_UPDATE_DARK_MODE, dark_mode_debounce_ms, nullptr);
+        break;
+    case WM_DPICHANGED:
+        // Window is on the primary monitor, so this is also the DPI of the taskbar
+        notify_icon->UpdateDpi(HIWORD(wParam));
         break;
     case WM_DESTROY:
         notify_icon->Remove();
@@ -221,6 +280,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         break;
     case NotifyIcon::MESSAGE:
         return notify_icon->HandleMessage(hWnd, wParam, lParam);
+    case NotifyIcon::MESSAGE_TOGGLE_DONE:
+        notify_icon->HandleToggleDone(wParam, lParam);
+        break;
     case WM_TIMER:
         HandleTimer(hWnd, wParam);
         break;
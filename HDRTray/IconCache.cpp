@@ -0,0 +1,61 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "IconCache.hpp"
+
+#include "Resource.h"
+
+#include <CommCtrl.h>
+
+IconCache::~IconCache()
+{
+    Clear();
+}
+
+HICON IconCache::Get(const Key& key)
+{
+    if (current && current->key == key)
+        return current->icon;
+
+    // HDR switches are rare, so loading the icon again then is cheaper than keeping both states around
+    Clear();
+    HICON icon = Load(key);
+    num_loads++;
+    if (icon)
+        current = Entry { key, icon };
+    return icon;
+}
+
+void IconCache::Clear()
+{
+    if (current)
+        DestroyIcon(current->icon);
+    current.reset();
+}
+
+HICON IconCache::Load(const Key& key)
+{
+    int resource_id = (key.hdr_on ? IDI_HDR_ON_DARKMODE : IDI_HDR_OFF_DARKMODE) + key.iconset;
+    /* The icon files contain images for all common scale factors,
+     * so this usually picks an exact size match */
+    int size = GetSystemMetricsForDpi(SM_CXSMICON, key.dpi);
+    HICON icon = nullptr;
+    if (FAILED(LoadIconWithScaleDown(hInst, MAKEINTRESOURCEW(resource_id), size, size, &icon)))
+        return nullptr;
+    return icon;
+}
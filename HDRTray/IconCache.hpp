@@ -0,0 +1,74 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef ICONCACHE_HPP_
+#define ICONCACHE_HPP_
+
+#include "framework.h"
+
+#include <cstdint>
+#include <optional>
+
+/**
+ * Loads notification area icons on demand, at the size matching a DPI.
+ * Only the most recently requested icon is kept; requesting an icon for another iconset,
+ * HDR state or DPI destroys the previous one. So no more icons are held than displayed.
+ * That's fine for a displayed icon, as the shell keeps its own copy.
+ */
+class IconCache
+{
+public:
+    enum Iconset { iconsetDarkMode = 0, iconsetLightMode, numIconsets };
+
+    struct Key
+    {
+        Iconset iconset;
+        bool hdr_on;
+        UINT dpi;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    IconCache() = default;
+    IconCache(const IconCache&) = delete;
+    ~IconCache();
+
+    IconCache& operator=(const IconCache&) = delete;
+
+    /// Get an icon, loading it if necessary. Returned handle is valid until the next call.
+    HICON Get(const Key& key);
+    /// Release the icon
+    void Clear();
+    /// Number of currently loaded icons
+    size_t GetNumLoaded() const { return current ? 1 : 0; }
+    /// Number of icon loads so far. A change means a handle value may have been reused for another icon
+    uint64_t GetNumLoads() const { return num_loads; }
+
+private:
+    struct Entry
+    {
+        Key key;
+        HICON icon;
+    };
+    std::optional<Entry> current;
+    uint64_t num_loads = 0;
+
+    static HICON Load(const Key& key);
+};
+
+#endif // ICONCACHE_HPP_
@@ -18,15 +18,20 @@
 
 #include "NotifyIcon.hpp"
 
+#include "Autostart.h"
 #include "l10n.h"
+#include "OsCapabilities.h"
 #include "Resource.h"
-#include "WinVerCheck.hpp"
+#include "SwitchCoalescer.h"
+#include "Trace.h"
 
 #include "Windows10Colors.h"
 
+#include <algorithm>
+#include <format>
+
 #include <CommCtrl.h>
 #include <windowsx.h>
-#include <winreg.h>
 
 /*
     Enabling dark mode based on this information:
@@ -45,7 +50,7 @@ static bool has_dark_mode_support;
 static void InitDarkModeSupport()
 {
     // This stuff only works with Windows 1903+
-    if (!IsWindows10_1903OrGreater())
+    if (!hdr::GetOsCapabilities().dark_mode_menus)
         return;
     // Already initialized?
     if (SetPreferredAppMode)
@@ -58,8 +63,21 @@ static void InitDarkModeSupport()
     has_dark_mode_support = SetPreferredAppMode && FlushMenuThemes;
 }
 
-static const wchar_t autostart_registry_path[] = L"Software\\Microsoft\\Windows\\CurrentVersion\\Run";
-static const wchar_t autostart_registry_key[] = L"HDRTray";
+static const wchar_t autostart_value_name[] = L"HDRTray";
+
+// Quote the executable path
+static std::wstring get_autostart_value()
+{
+    wchar_t* exe_path = nullptr;
+    _get_wpgmptr(&exe_path);
+
+    std::wstring result;
+    result.reserve(wcslen(exe_path) + 2);
+    result.push_back('"');
+    result.append(exe_path);
+    result.push_back('"');
+    return result;
+}
 
 // Wraps Shell_NotifyIconW(), prints to debug output in case of a failure
 static BOOL wrap_Shell_NotifyIconW(DWORD message, NOTIFYICONDATAW* data)
@@ -97,63 +115,114 @@ static BOOL wrap_Shell_NotifyIconW(DWORD message, NOTIFYICONDATAW* data)
     return result;
 }
 
-NotifyIcon::NotifyIcon(HWND hwnd)
+namespace {
+// Notification area icon, backed by Shell_NotifyIconW()
+class Win32Shell : public tray::Shell
 {
-    InitDarkModeSupport();
+    NOTIFYICONDATAW notify_template;
+
+    static void SetTip(NOTIFYICONDATAW& data, const tray::IconState& state)
+    {
+        wcsncpy_s(data.szTip, state.tip.c_str(), _TRUNCATE);
+    }
+
+public:
+    Win32Shell(HWND hwnd, UINT callback_message)
+    {
+        notify_template = NOTIFYICONDATAW { sizeof(NOTIFYICONDATAW) };
+        notify_template.hWnd = hwnd;
+        notify_template.uID = 0;
+        notify_template.uFlags = NIF_MESSAGE | NIF_SHOWTIP;
+        notify_template.uCallbackMessage = callback_message;
+    }
+
+    bool Add(const tray::IconState& state) override
+    {
+        auto notify_add = notify_template;
+        notify_add.uFlags |= NIF_ICON | NIF_TIP;
+        notify_add.hIcon = static_cast<HICON>(const_cast<void*>(state.icon));
+        SetTip(notify_add, state);
+        if (!wrap_Shell_NotifyIconW(NIM_ADD, &notify_add))
+            return false;
+
+        auto notify_setversion = notify_template;
+        notify_setversion.uVersion = NOTIFYICON_VERSION_4;
+        wrap_Shell_NotifyIconW(NIM_SETVERSION, &notify_setversion);
+        return true;
+    }
+
+    bool Modify(const tray::IconState& state, unsigned fields) override
+    {
+        auto notify_mod = notify_template;
+        if (fields & tray::IconFieldIcon) {
+            notify_mod.uFlags |= NIF_ICON;
+            notify_mod.hIcon = static_cast<HICON>(const_cast<void*>(state.icon));
+        }
+        if (fields & tray::IconFieldTip) {
+            notify_mod.uFlags |= NIF_TIP;
+            SetTip(notify_mod, state);
+        }
+        return wrap_Shell_NotifyIconW(NIM_MODIFY, &notify_mod);
+    }
 
-    notify_template = NOTIFYICONDATAW { sizeof(NOTIFYICONDATAW) };
-    notify_template.hWnd = hwnd;
-    notify_template.uID = 0;
-    notify_template.uFlags = NIF_MESSAGE | NIF_SHOWTIP;
-    notify_template.uCallbackMessage = MESSAGE;
+    bool Delete() override
+    {
+        auto notify_delete = notify_template;
+        return wrap_Shell_NotifyIconW(NIM_DELETE, &notify_delete);
+    }
 
-    for (int i = 0; i < numIconsets; i++) {
-        LoadIconMetric(hInst, MAKEINTRESOURCEW(IDI_HDR_ON_DARKMODE + i), LIM_SMALL, &icons[i].hdr_on);
-        LoadIconMetric(hInst, MAKEINTRESOURCEW(IDI_HDR_OFF_DARKMODE + i), LIM_SMALL, &icons[i].hdr_off);
+    bool ShowErrorBalloon(std::wstring_view text) override
+    {
+        auto notify_balloon_tip = notify_template;
+        notify_balloon_tip.uFlags |= NIF_INFO | NIF_REALTIME;
+        size_t num_copy = std::min(std::size(notify_balloon_tip.szInfo) - 1, text.size());
+        std::copy_n(text.data(), num_copy, notify_balloon_tip.szInfo);
+        notify_balloon_tip.szInfo[num_copy] = 0;
+        notify_balloon_tip.dwInfoFlags = NIIF_ERROR;
+        return wrap_Shell_NotifyIconW(NIM_MODIFY, &notify_balloon_tip);
     }
+};
+} // anonymous namespace
+
+NotifyIcon::NotifyIcon(HWND hwnd)
+    : shell(std::make_unique<Win32Shell>(hwnd, MESSAGE)), icon_tracker(*shell), hwnd(hwnd), dpi(GetDpiForWindow(hwnd))
+{
+    InitDarkModeSupport();
+
     popup_menu = LoadMenuW(hInst, MAKEINTRESOURCEW(IDC_TRAYPOPUP));
+
+    run_key = autostart::OpenWin32RunKey();
+    autostart_state =
+        std::make_unique<autostart::AutostartState>(*run_key, autostart_value_name, get_autostart_value());
+
+    toggle_worker = std::make_unique<ToggleWorker>([hwnd](std::optional<hdr::Status> result) {
+        PostMessageW(hwnd, MESSAGE_TOGGLE_DONE, 0, result ? static_cast<LPARAM>(*result) : -1);
+    });
 }
 
 NotifyIcon::~NotifyIcon()
 {
-    for (int i = 0; i < numIconsets; i++) {
-        DestroyIcon(icons[i].hdr_on);
-        DestroyIcon(icons[i].hdr_off);
-    }
     DestroyMenu(popup_menu);
 }
 
 bool NotifyIcon::WasAdded() const
 {
-    return added;
+    return icon_tracker.IsAdded();
 }
 
 bool NotifyIcon::Add()
 {
     FetchHDRStatus();
     FetchDarkMode();
+    // Taskbar may have been re-created due to a DPI change
+    dpi = GetDpiForWindow(hwnd);
 
-    auto notify_add = notify_template;
-    notify_add.hIcon = GetCurrentIconSet().hdr_off;
-    l10n::LoadString(IDS_APP_TITLE, notify_add.szTip);
-    notify_add.uFlags |= NIF_ICON | NIF_TIP | NIF_SHOWTIP;
-    if(!wrap_Shell_NotifyIconW(NIM_ADD, &notify_add))
-        return false;
-
-    auto notify_setversion = notify_template;
-    notify_setversion.uVersion = NOTIFYICON_VERSION_4;
-    wrap_Shell_NotifyIconW(NIM_SETVERSION, &notify_setversion);
-
-    UpdateIcon();
-    added = true;
-    return true;
+    return icon_tracker.Add(GetIconState());
 }
 
 void NotifyIcon::Remove()
 {
-    auto notify_delete = notify_template;
-    wrap_Shell_NotifyIconW(NIM_DELETE, &notify_delete);
-    added = false;
+    icon_tracker.Remove();
 }
 
 bool NotifyIcon::UpdateHDRStatus()
@@ -168,12 +237,27 @@ bool NotifyIcon::UpdateHDRStatus()
     return false;
 }
 
+bool NotifyIcon::IsDarkModeSettingChange(const wchar_t* area)
+{
+    stats.setting_changes++;
+    // Task bar color mode changes are signalled with this area name
+    return area && wcscmp(area, L"ImmersiveColorSet") == 0;
+}
+
 void NotifyIcon::UpdateDarkMode()
 {
     FetchDarkMode();
     UpdateIcon();
 }
 
+void NotifyIcon::UpdateDpi(UINT new_dpi)
+{
+    if (new_dpi == dpi)
+        return;
+    dpi = new_dpi;
+    UpdateIcon();
+}
+
 LRESULT NotifyIcon::HandleMessage(HWND hWnd, WPARAM wParam, LPARAM lParam)
 {
     auto event = LOWORD(lParam);
@@ -190,92 +274,76 @@ LRESULT NotifyIcon::HandleMessage(HWND hWnd, WPARAM wParam, LPARAM lParam)
     return 0;
 }
 
-// Quote the executable path
-static std::wstring get_autostart_value()
+void NotifyIcon::ToggleAutostartEnabled()
 {
-    wchar_t* exe_path = nullptr;
-    _get_wpgmptr(&exe_path);
-
-    std::wstring result;
-    result.reserve(wcslen(exe_path) + 2);
-    result.push_back('"');
-    result.append(exe_path);
-    result.push_back('"');
-    return result;
+    autostart_state->SetEnabled(!autostart_state->IsEnabled());
 }
 
-static bool is_autostart_enabled(HKEY key_autostart, const wchar_t* autostart_value)
+void NotifyIcon::ToggleHDR()
 {
-    DWORD value_type = 0;
-    DWORD value_size = 0;
-    auto query_value_res = RegQueryValueExW(key_autostart, autostart_registry_key, nullptr, &value_type, nullptr, &value_size);
-    bool has_auto_start = (query_value_res == ERROR_SUCCESS) || (query_value_res == ERROR_MORE_DATA);
-    if(has_auto_start)
-        has_auto_start &= value_type == REG_SZ;
-    if(has_auto_start)
-    {
-        DWORD value_len = value_size / sizeof(WCHAR);
-        DWORD buf_size = (value_len + 1) * sizeof(WCHAR);
-        auto* buf = reinterpret_cast<WCHAR*>(_alloca(buf_size));
-        if (RegQueryValueExW(key_autostart, autostart_registry_key, nullptr, nullptr, reinterpret_cast<BYTE*>(buf),
-                             &buf_size)
-            == ERROR_SUCCESS) {
-            buf[value_len] = 0;
-            has_auto_start = _wcsicmp(buf, autostart_value) == 0;
-        } else {
-            has_auto_start = false;
-        }
-    }
-
-    return has_auto_start;
+    /* Toggling HDR moves the mouse cursor to the screen center,
+     * so save it's position, to restore it once done */
+    if (!has_toggle_mouse_pos)
+        has_toggle_mouse_pos = GetCursorPos(&toggle_mouse_pos);
+    if (!toggle_start_time)
+        toggle_start_time = std::chrono::steady_clock::now();
+
+    // Switching may take a while, so do it in the background
+    toggle_worker->Request();
+    UpdateIcon();
 }
 
-void NotifyIcon::ToggleAutostartEnabled()
+void NotifyIcon::HandleToggleDone(WPARAM wParam, LPARAM lParam)
 {
-    HKEY key_autostart = nullptr;
-    if (RegCreateKeyExW(HKEY_CURRENT_USER, autostart_registry_path, 0, nullptr, 0,
-                        KEY_READ | KEY_WRITE | KEY_QUERY_VALUE | KEY_SET_VALUE, nullptr, &key_autostart, nullptr)
-        != ERROR_SUCCESS)
-        return;
-
-    auto autostart_value = get_autostart_value();
+    UNREFERENCED_PARAMETER(wParam);
 
-    auto has_auto_start = is_autostart_enabled(key_autostart, autostart_value.c_str());
-
-    bool new_auto_start = !has_auto_start;
-    if(new_auto_start) {
-        RegSetValueExW(key_autostart, autostart_registry_key, 0, REG_SZ, reinterpret_cast<const BYTE*>(autostart_value.c_str()),
-                       static_cast<DWORD>((autostart_value.size() + 1) * sizeof(WCHAR)));
+    if (lParam >= 0) {
+        hdr_status = static_cast<hdr::Status>(lParam);
     } else {
-        RegDeleteValueW(key_autostart, autostart_registry_key);
+        // Pop up error balloon if toggle failed
+        shell->ShowErrorBalloon(l10n::LoadString(IDS_TOGGLE_HDR_ERROR));
     }
 
-    RegCloseKey(key_autostart);
-}
-
-void NotifyIcon::ToggleHDR()
-{
-    /* Toggling HDR moves the mouse cursor to the screen center,
-     * so save & restore it's position */
-    POINT mouse_pos;
-    bool has_mouse_pos = GetCursorPos(&mouse_pos);
+    // More toggles may have been requested in the meantime
+    if (!toggle_worker->IsBusy() && has_toggle_mouse_pos) {
+        SetCursorPos(toggle_mouse_pos.x, toggle_mouse_pos.y);
+        has_toggle_mouse_pos = false;
+    }
 
-    auto new_status = hdr::ToggleHDRStatus();
+    UpdateIcon();
 
-    if(new_status) {
-        hdr_status = *new_status;
-        UpdateIcon();
-    } else {
-        // Pop up error balloon if toggle failed
-        auto notify_balloon_tip = notify_template;
-        notify_balloon_tip.uFlags |= NIF_INFO | NIF_REALTIME;
-        l10n::LoadString(IDS_TOGGLE_HDR_ERROR, notify_balloon_tip.szInfo);
-        notify_balloon_tip.dwInfoFlags = NIIF_ERROR;
-        Shell_NotifyIconW(NIM_MODIFY, &notify_balloon_tip);
+    // Record time from click to icon update
+    if (!toggle_worker->IsBusy() && toggle_start_time) {
+        hdr::trace::Record("tray.toggle", nullptr, std::chrono::steady_clock::now() - *toggle_start_time);
+        toggle_start_time.reset();
     }
+}
+
+void NotifyIcon::ShowStatistics()
+{
+    auto switch_stats = hdr::GetSwitchCoalescer().GetStats();
+    auto autostart_stats = autostart_state->GetStats();
+    auto text = std::format("Switch requests: {}, coalesced: {}, executed: {}\n"
+                            "Setting changes: {}, dark mode evaluations: {}, menu theme flushes: {}\n"
+                            "Autostart queries: {}, registry reads: {}\n\n",
+                            switch_stats.requests, switch_stats.coalesced, switch_stats.executed,
+                            stats.setting_changes, stats.dark_mode_evaluations, stats.menu_theme_flushes,
+                            autostart_stats.queries, autostart_stats.reads);
+    text.append(hdr::trace::FormatText(hdr::trace::GetSpanStats()));
+
+    wchar_t path[MAX_PATH + 1];
+    auto temp_len = GetTempPathW(MAX_PATH + 1, path);
+    if (temp_len == 0 || swprintf_s(path + temp_len, std::size(path) - temp_len, L"HDRTray-statistics.txt") < 0)
+        return;
 
-    if(has_mouse_pos)
-        SetCursorPos(mouse_pos.x, mouse_pos.y);
+    HANDLE file = CreateFileW(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    DWORD written = 0;
+    bool write_ok = WriteFile(file, text.data(), static_cast<DWORD>(text.size()), &written, nullptr);
+    CloseHandle(file);
+    if (write_ok)
+        ShellExecuteW(nullptr, L"open", path, nullptr, nullptr, SW_SHOWNORMAL);
 }
 
 void NotifyIcon::PopupIconMenu(HWND hWnd, POINT pos)
@@ -307,67 +375,83 @@ void NotifyIcon::PopupIconMenu(HWND hWnd, POINT pos)
         | (menu_right_align ? TPM_HORNEGANIMATION | TPM_RIGHTALIGN : TPM_HORPOSANIMATION | TPM_LEFTALIGN);
     TrackPopupMenuEx(GetSubMenu(popup_menu, 0), flags, pos.x, pos.y, hWnd, nullptr);
 }
-const NotifyIcon::Icons& NotifyIcon::GetCurrentIconSet() const
+HICON NotifyIcon::GetIcon(bool hdr_on)
 {
-    return icons[dark_mode_icons ? iconsetDarkMode : iconsetLightMode];
+    HICON icon =
+        icon_cache.Get({ dark_mode_icons ? IconCache::iconsetDarkMode : IconCache::iconsetLightMode, hdr_on, dpi });
+    // A newly loaded icon may reuse the handle value of the one it replaced
+    if (icon_cache.GetNumLoads() != icon_loads) {
+        icon_loads = icon_cache.GetNumLoads();
+        icon_tracker.InvalidateIcon();
+    }
+    return icon;
 }
 
 void NotifyIcon::FetchHDRStatus()
 {
+    // Avoid waiting for a running toggle; status is updated once it completes
+    if (toggle_worker->IsBusy())
+        return;
+
     this->hdr_status = hdr::GetWindowsHDRStatus();
 }
 
 void NotifyIcon::FetchDarkMode()
 {
+    stats.dark_mode_evaluations++;
     windows10colors::SysPartsMode sys_parts_coloring;
     if(FAILED(GetSysPartsMode(sys_parts_coloring)))
         return;
 
     // In both "dark" and "accented" modes the task bar is dark enough to require light text
-    dark_mode_icons = sys_parts_coloring != windows10colors::SysPartsMode::Light;
+    bool new_dark_mode_icons = sys_parts_coloring != windows10colors::SysPartsMode::Light;
+    if (menu_mode_applied && new_dark_mode_icons == dark_mode_icons)
+        return;
+    dark_mode_icons = new_dark_mode_icons;
+    menu_mode_applied = true;
 
     if (has_dark_mode_support) {
+        stats.menu_theme_flushes++;
         // Make context menu popup mode match task bar mode
         SetPreferredAppMode(dark_mode_icons ? PreferredAppMode::ForceDark : PreferredAppMode::ForceLight);
         FlushMenuThemes();
     }
 }
 
-void NotifyIcon::UpdateIcon()
+tray::IconState NotifyIcon::GetIconState()
 {
-    auto notify_mod = notify_template;
-    notify_mod.uFlags |= NIF_ICON | NIF_TIP;
+    tray::IconState state;
+    if (toggle_worker->IsBusy()) {
+        state.icon = GetIcon(hdr_status == hdr::Status::On);
+        state.tip = l10n::LoadString(IDS_HDR_SWITCHING);
+        return state;
+    }
     switch(hdr_status)
     {
     default:
     case hdr::Status::Unsupported:
-        notify_mod.hIcon = GetCurrentIconSet().hdr_off;
-        l10n::LoadString(IDS_HDR_UNSUPPORTED, notify_mod.szTip);
+        state.icon = GetIcon(false);
+        state.tip = l10n::LoadString(IDS_HDR_UNSUPPORTED);
         break;
     case hdr::Status::Off:
-        notify_mod.hIcon = GetCurrentIconSet().hdr_off;
-        l10n::LoadString(IDS_HDR_OFF, notify_mod.szTip);
+        state.icon = GetIcon(false);
+        state.tip = l10n::LoadString(IDS_HDR_OFF);
         break;
     case hdr::Status::On:
-        notify_mod.hIcon = GetCurrentIconSet().hdr_on;
-        l10n::LoadString(IDS_HDR_ON, notify_mod.szTip);
+        state.icon = GetIcon(true);
+        state.tip = l10n::LoadString(IDS_HDR_ON);
         break;
     }
-    Shell_NotifyIconW(NIM_MODIFY, &notify_mod);
-
+    return state;
 }
 
-bool NotifyIcon::IsAutostartEnabled() const
+void NotifyIcon::UpdateIcon()
 {
-    HKEY key_autostart = nullptr;
-    if (RegOpenKeyExW(HKEY_CURRENT_USER, autostart_registry_path, 0, KEY_READ | KEY_QUERY_VALUE, &key_autostart) != ERROR_SUCCESS)
-        return false;
-
-    auto autostart_value = get_autostart_value();
-
-    auto has_auto_start = is_autostart_enabled(key_autostart, autostart_value.c_str());
-
-    RegCloseKey(key_autostart);
+    // Only sends anything to the shell if the icon actually changed
+    icon_tracker.Update(GetIconState());
+}
 
-    return has_auto_start;
+bool NotifyIcon::IsAutostartEnabled()
+{
+    return autostart_state->IsEnabled();
 }
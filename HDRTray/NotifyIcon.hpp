@@ -20,27 +20,60 @@
 #define NOTIFYICON_HPP_
 
 #include "framework.h"
+#include "Autostart.h"
 #include "HDR.h"
+#include "IconCache.hpp"
+#include "ToggleWorker.hpp"
+#include "TrayIcon.h"
+
+#include <chrono>
+#include <memory>
+#include <optional>
 
 #include <shellapi.h>
 
 class NotifyIcon
 {
-    bool added = false;
-    NOTIFYICONDATAW notify_template;
-
-    enum { iconsetDarkMode = 0, iconsetLightMode, numIconsets };
-    struct Icons
+public:
+    struct Stats
     {
-        HICON hdr_on;
-        HICON hdr_off;
+        /// WM_SETTINGCHANGE messages received
+        uint64_t setting_changes = 0;
+        /// Dark mode evaluations performed
+        uint64_t dark_mode_evaluations = 0;
+        /// Context menu theme flushes performed
+        uint64_t menu_theme_flushes = 0;
     };
-    Icons icons[numIconsets];
+
+private:
+    std::unique_ptr<tray::Shell> shell;
+    tray::IconStateTracker icon_tracker;
+
+    HWND hwnd;
+    IconCache icon_cache;
+    /// Icon loads seen, to notice handle values that may have been reused
+    uint64_t icon_loads = 0;
+    /// DPI the icons are displayed at
+    UINT dpi;
     HMENU popup_menu;
 
     bool dark_mode_icons = false;
+    /// Whether the context menu mode was set to match dark_mode_icons
+    bool menu_mode_applied = false;
     hdr::Status hdr_status = hdr::Status::Unsupported;
 
+    Stats stats;
+
+    std::unique_ptr<autostart::RunKey> run_key;
+    std::unique_ptr<autostart::AutostartState> autostart_state;
+
+    std::unique_ptr<ToggleWorker> toggle_worker;
+    // Mouse cursor position saved when a toggle started
+    POINT toggle_mouse_pos;
+    bool has_toggle_mouse_pos = false;
+    // Time the first of a series of toggles was requested
+    std::optional<std::chrono::steady_clock::time_point> toggle_start_time;
+
 public:
     NotifyIcon(HWND hwnd);
     ~NotifyIcon();
@@ -50,24 +83,40 @@ public:
     void Remove();
 
     bool UpdateHDRStatus();
+    /**
+     * Check whether a WM_SETTINGCHANGE may affect dark mode.
+     * \param area Area name passed with the message. May be \c nullptr.
+     * \returns Whether UpdateDarkMode() should be called.
+     */
+    bool IsDarkModeSettingChange(const wchar_t* area);
     void UpdateDarkMode();
+    /// Handle a change of the DPI icons are displayed at
+    void UpdateDpi(UINT new_dpi);
 
     LRESULT HandleMessage(HWND hWnd, WPARAM wParam, LPARAM lParam);
 
+    const Stats& GetStats() const { return stats; }
+
     enum { MESSAGE = WM_USER + 11 };
+    /// Posted when an HDR toggle completed
+    enum { MESSAGE_TOGGLE_DONE = WM_USER + 12 };
 
     void ToggleAutostartEnabled();
+    /// Write collected statistics to a file and open it
+    void ShowStatistics();
     void ToggleHDR();
+    void HandleToggleDone(WPARAM wParam, LPARAM lParam);
 
 protected:
     void PopupIconMenu(HWND hWnd, POINT pos);
 
-    const Icons& GetCurrentIconSet() const;
+    HICON GetIcon(bool hdr_on);
     void FetchHDRStatus();
     void FetchDarkMode();
+    tray::IconState GetIconState();
     void UpdateIcon();
 
-    bool IsAutostartEnabled() const;
+    bool IsAutostartEnabled();
 };
 
 #endif // NOTIFYICON_HPP_
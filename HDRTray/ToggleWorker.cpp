@@ -0,0 +1,91 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "ToggleWorker.hpp"
+
+#include "SwitchCoalescer.h"
+
+#include <algorithm>
+
+ToggleWorker::ToggleWorker(DoneFunc done_func) : done_func(std::move(done_func))
+{
+    thread = std::thread([this]() { Run(); });
+}
+
+ToggleWorker::~ToggleWorker()
+{
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    wakeup.notify_one();
+    thread.join();
+}
+
+void ToggleWorker::Request()
+{
+    {
+        // Lock so the worker can't miss the request between checking for and waiting on one
+        std::lock_guard lock(mutex);
+        hdr::GetSwitchCoalescer().Add(hdr::SwitchCoalescer::Request::Toggle);
+    }
+    wakeup.notify_one();
+}
+
+bool ToggleWorker::IsBusy() const
+{
+    return hdr::GetSwitchCoalescer().IsBusy();
+}
+
+static std::optional<hdr::Status> PerformSwitch(hdr::SwitchCoalescer::Request request)
+{
+    switch (request) {
+    case hdr::SwitchCoalescer::Request::Toggle:
+        break;
+    case hdr::SwitchCoalescer::Request::Enable:
+        return hdr::SetWindowsHDRStatus(true);
+    case hdr::SwitchCoalescer::Request::Disable:
+        return hdr::SetWindowsHDRStatus(false);
+    }
+    return hdr::ToggleHDRStatus();
+}
+
+void ToggleWorker::Run()
+{
+    auto& coalescer = hdr::GetSwitchCoalescer();
+    std::unique_lock lock(mutex);
+    while (!stop) {
+        auto delay = coalescer.TimeUntilNextSwitch();
+        if (!delay) {
+            wakeup.wait(lock);
+            continue;
+        }
+        auto request = coalescer.BeginSwitch();
+        if (!request) {
+            // Too early, or a switch is running elsewhere in the process
+            wakeup.wait_for(lock, std::max<hdr::Clock::duration>(*delay, std::chrono::milliseconds(10)));
+            continue;
+        }
+
+        lock.unlock();
+        auto result = PerformSwitch(*request);
+        coalescer.EndSwitch();
+        done_func(result);
+        lock.lock();
+    }
+}
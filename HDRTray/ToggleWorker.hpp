@@ -0,0 +1,64 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TOGGLEWORKER_HPP_
+#define TOGGLEWORKER_HPP_
+
+#include "HDR.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+/**
+ * Toggles HDR on a separate thread, as switching modes may take a while.
+ * Requests go through the process-wide hdr::SwitchCoalescer: only one toggle runs at a time,
+ * requests arriving while a toggle is running are coalesced (an even number of extra requests
+ * cancels out, an odd number results in one more toggle), and toggles are rate-limited.
+ */
+class ToggleWorker
+{
+public:
+    /**
+     * Function called when a toggle completed. Called on the worker thread.
+     * \param result Result of hdr::ToggleHDRStatus() or hdr::SetWindowsHDRStatus().
+     */
+    using DoneFunc = std::function<void(std::optional<hdr::Status> result)>;
+
+    explicit ToggleWorker(DoneFunc done_func);
+    ~ToggleWorker();
+
+    /// Request a toggle
+    void Request();
+    /// Whether a toggle is running or pending
+    bool IsBusy() const;
+
+private:
+    DoneFunc done_func;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stop = false;
+    std::thread thread;
+
+    void Run();
+};
+
+#endif // TOGGLEWORKER_HPP_
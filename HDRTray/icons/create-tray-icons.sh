@@ -20,14 +20,24 @@
 # Generate the notification area icon files from SVGs
 # This was written for use with WSL and requires inkscape, icoutils and imagemagick installed
 
+cd "$(dirname "$0")"
+
+# Display scale factors offered by Windows: 25% increments until 250%, and 50% increments after that.
+# The icon files contain an image for each of these, so the icon loaded for the current DPI
+# never needs to be scaled at runtime.
+scale_factors=(100 125 150 175 200 225 250 300 350 400 450 500)
+# Base notification icon size
+base_size=16
+
 icon_from_svg()
 {
     fn_base=$1
 
-    # Icon sizes to generate.
-    # Base notification icon size is 16x16, but allow for scaling up to 500%,
-    # with 25% increments until 250%, and 50% increments after that
-    sizes=(16 20 24 28 32 36 40 48 56 64 72 80)
+    # Icon sizes to generate
+    sizes=()
+    for f in ${scale_factors[@]}; do
+        sizes+=($(( base_size * f / 100 )))
+    done
 
     mkdir -p tmp
     args_bow=()
@@ -0,0 +1,693 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Benchmarks for the hdr:: functions, using a simulated display configuration backend
+
+#include "CLI/CLI.hpp"
+
+#include "CommandServer.h"
+#include "DisplayConfigSim.h"
+#include "DisplayList.h"
+#include "HDR.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <map>
+#include <new>
+#include <optional>
+#include <print>
+#include <sstream>
+#include <thread>
+
+#if defined(_WIN32)
+#include "framework.h"
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+using namespace hdr::display_config;
+using milliseconds_f = std::chrono::duration<double, std::milli>;
+
+// Count allocations, to report allocations per operation
+static std::atomic<uint64_t> num_allocations;
+
+void* operator new(size_t size)
+{
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+/// Settings for "switch" benchmark
+struct SwitchOptions
+{
+    size_t max_displays = 16;
+    size_t num_adapters = 2;
+    double set_latency_ms = 100;
+    double query_latency_ms = 1;
+};
+
+static milliseconds_f TimeSwitch(SimulatedBackend& backend, const SwitchOptions& options, size_t num_displays,
+                                 hdr::SwitchMode mode)
+{
+    // Start out with HDR off everywhere, and a warm topology snapshot
+    backend.SetDisplays(MakeExtendedTopology(num_displays, options.num_adapters));
+    hdr::InvalidateTopology();
+    hdr::GetWindowsHDRStatus();
+
+    auto start = std::chrono::steady_clock::now();
+    hdr::SetWindowsHDRStatus(true, mode);
+    return std::chrono::steady_clock::now() - start;
+}
+
+// Measure wall-clock time of SetWindowsHDRStatus(), sequential vs parallel, for increasing display counts
+static void BenchSwitch(const SwitchOptions& options)
+{
+    SimulatedBackend backend;
+    backend.SetLatency(std::chrono::duration_cast<std::chrono::nanoseconds>(milliseconds_f(options.query_latency_ms)));
+    auto set_latency = std::chrono::duration_cast<std::chrono::nanoseconds>(milliseconds_f(options.set_latency_ms));
+    backend.SetLatency(Call::SetHdrState, set_latency);
+    backend.SetLatency(Call::SetAdvancedColorState, set_latency);
+    SetBackend(&backend);
+
+    std::println("{} adapter(s), {} ms per switch, {} ms per query", options.num_adapters, options.set_latency_ms,
+                 options.query_latency_ms);
+    std::println("{:>8}\t{:>14}\t{:>12}\t{:>7}", "Displays", "Sequential, ms", "Parallel, ms", "Speedup");
+    for (size_t num_displays = 1; num_displays <= options.max_displays; num_displays *= 2) {
+        auto sequential = TimeSwitch(backend, options, num_displays, hdr::SwitchMode::Sequential);
+        auto parallel = TimeSwitch(backend, options, num_displays, hdr::SwitchMode::Parallel);
+        std::println("{:>8}\t{:>14.1f}\t{:>12.1f}\t{:>7.2f}", num_displays, sequential.count(), parallel.count(),
+                     sequential / parallel);
+    }
+
+    SetBackend(nullptr);
+}
+
+/// Operations for "ops" benchmark
+enum class Op { Status, Displays, DisplayList, Set, Toggle };
+/// Display topologies for "ops" benchmark
+enum class Topology { Extended, Clone, MixedClone, MultiPath };
+
+/// Settings for "ops" benchmark
+struct OpsOptions
+{
+    size_t num_ops = 1000;
+    size_t num_displays = 2;
+    size_t num_adapters = 1;
+    double latency_ms = 0;
+    double failure_rate = 0;
+    /// Seed for failure injection
+    uint32_t seed = std::minstd_rand::default_seed;
+    Topology topology = Topology::Extended;
+    hdr::ApiGeneration api = hdr::ApiGeneration::Win11_24H2;
+    /**
+     * Cache invalidation before each operation: "none", "status", "topology", or "hotplug"
+     * (topology, which also changes while it's queried)
+     */
+    std::string invalidate = "status";
+    std::vector<Op> ops = { Op::Status, Op::Displays, Op::DisplayList, Op::Set, Op::Toggle };
+    /// File with maximum calls and allocations per operation. If set, exceeding them is an error
+    std::string baseline;
+};
+
+static std::string_view OpName(Op op)
+{
+    switch (op) {
+    case Op::Status:
+        return "GetWindowsHDRStatus";
+    case Op::Displays:
+        return "GetDisplays";
+    case Op::DisplayList:
+        return "GetDisplays (list)";
+    case Op::Set:
+        return "SetWindowsHDRStatus";
+    case Op::Toggle:
+        return "ToggleHDRStatus";
+    }
+    return "???";
+}
+
+/// Name of operation on the command line and in baseline files
+static std::string_view OpKey(Op op)
+{
+    switch (op) {
+    case Op::Status:
+        return "status";
+    case Op::Displays:
+        return "displays";
+    case Op::DisplayList:
+        return "list";
+    case Op::Set:
+        return "set";
+    case Op::Toggle:
+        return "toggle";
+    }
+    return "???";
+}
+
+static std::string_view TopologyName(Topology topology)
+{
+    switch (topology) {
+    case Topology::Extended:
+        return "extended";
+    case Topology::Clone:
+        return "clone";
+    case Topology::MixedClone:
+        return "mixed";
+    case Topology::MultiPath:
+        return "multipath";
+    }
+    return "???";
+}
+
+static std::vector<SimulatedDisplay> MakeTopology(const OpsOptions& options)
+{
+    switch (options.topology) {
+    case Topology::Extended:
+        break;
+    case Topology::Clone:
+        return MakeCloneTopology(options.num_displays, options.num_adapters);
+    case Topology::MixedClone:
+        return MakeMixedCloneTopology(options.num_displays, options.num_adapters);
+    case Topology::MultiPath:
+        return MakeMultiPathTopology(options.num_displays, options.num_adapters, 2);
+    }
+    return MakeExtendedTopology(options.num_displays, options.num_adapters);
+}
+
+static uint64_t TotalCalls(const Backend& backend)
+{
+    uint64_t total = 0;
+    for (size_t i = 0; i < numCalls; i++)
+        total += backend.GetStats(static_cast<Call>(i)).count;
+    return total;
+}
+
+static void RunOp(Op op, size_t index, hdr::DisplayList& display_list)
+{
+    switch (op) {
+    case Op::Status:
+        hdr::GetWindowsHDRStatus();
+        break;
+    case Op::Displays:
+        hdr::GetDisplays();
+        break;
+    case Op::DisplayList:
+        // Reused across operations, like a poller would
+        hdr::GetDisplays(display_list);
+        break;
+    case Op::Set:
+        // Alternate, so each operation actually switches
+        hdr::SetWindowsHDRStatus(index % 2 == 0);
+        break;
+    case Op::Toggle:
+        hdr::ToggleHDRStatus();
+        break;
+    }
+}
+
+/// Maximum calls and allocations per operation
+struct OpsLimits
+{
+    double calls = 0;
+    double allocations = 0;
+};
+
+/**
+ * Read a baseline file. Each line has an operation name, maximum calls per operation,
+ * and maximum allocations per operation, separated by whitespace. Lines starting with '#' are ignored.
+ */
+static std::optional<std::map<std::string, OpsLimits>> ReadBaseline(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        std::println(stderr, "Can't open baseline {}", path);
+        return std::nullopt;
+    }
+    std::map<std::string, OpsLimits> baseline;
+    std::string line;
+    for (int line_num = 1; std::getline(file, line); line_num++) {
+        if (line.empty() || line.front() == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string op;
+        OpsLimits limits;
+        if (!(fields >> op >> limits.calls >> limits.allocations)) {
+            std::println(stderr, "{}:{}: malformed baseline entry", path, line_num);
+            return std::nullopt;
+        }
+        baseline.insert_or_assign(std::move(op), limits);
+    }
+    return baseline;
+}
+
+/**
+ * Measure throughput and cost of the hdr:: core functions: operations per second,
+ * display configuration calls per operation, and allocations per operation.
+ * Returns nonzero if a baseline is given and exceeded.
+ */
+static int BenchOps(const OpsOptions& options)
+{
+    std::map<std::string, OpsLimits> baseline;
+    if (!options.baseline.empty()) {
+        auto read_baseline = ReadBaseline(options.baseline);
+        if (!read_baseline)
+            return 2;
+        baseline = std::move(*read_baseline);
+    }
+
+    auto displays = MakeTopology(options);
+    // For "hotplug": alternate between the displays with and without an extra one
+    auto hotplug_options = options;
+    hotplug_options.num_displays++;
+    auto hotplug_displays = MakeTopology(hotplug_options);
+    SimulatedBackend backend(displays);
+    backend.SetHasHdrStateFunctions(options.api != hdr::ApiGeneration::Legacy);
+    backend.SetLatency(std::chrono::duration_cast<std::chrono::nanoseconds>(milliseconds_f(options.latency_ms)));
+    backend.SetFailureRate(options.failure_rate);
+    SetBackend(&backend);
+
+    std::println("{} op(s), {} display(s) on {} adapter(s), {} topology, {} API, {} ms per call, failure rate {} "
+                 "(seed {}), invalidate {}",
+                 options.num_ops, options.num_displays, options.num_adapters, TopologyName(options.topology),
+                 options.api == hdr::ApiGeneration::Legacy ? "legacy" : "24H2", options.latency_ms,
+                 options.failure_rate, options.seed, options.invalidate);
+    std::println("{:<20}\t{:>12}\t{:>9}\t{:>10}", "Operation", "Ops/s", "Calls/op", "Allocs/op");
+    hdr::DisplayList display_list;
+    int result = 0;
+    for (auto op : options.ops) {
+        // Same starting point for every operation: HDR off, warm topology and display list, same failures
+        backend.SetDisplays(displays);
+        backend.SetFailureRate(0);
+        hdr::InvalidateTopology();
+        hdr::GetWindowsHDRStatus();
+        hdr::GetDisplays(display_list);
+        backend.SetFailureRate(options.failure_rate);
+        backend.SetFailureSeed(options.seed);
+        backend.ResetStats();
+
+        std::chrono::nanoseconds total {};
+        uint64_t allocations = 0;
+        for (size_t i = 0; i < options.num_ops; i++) {
+            // Invalidation is part of the setup, not of the measured operation
+            if (options.invalidate == "topology") {
+                hdr::InvalidateTopology();
+            } else if (options.invalidate == "hotplug") {
+                backend.QueueHotplug(i % 2 == 0 ? hotplug_displays : displays);
+                hdr::InvalidateTopology();
+            } else if (options.invalidate == "status") {
+                hdr::InvalidateStatus();
+            }
+
+            auto allocations_before = num_allocations.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+            RunOp(op, i, display_list);
+            total += std::chrono::steady_clock::now() - start;
+            allocations += num_allocations.load(std::memory_order_relaxed) - allocations_before;
+        }
+
+        auto num_ops = static_cast<double>(options.num_ops);
+        auto calls_per_op = static_cast<double>(TotalCalls(backend)) / num_ops;
+        auto allocs_per_op = static_cast<double>(allocations) / num_ops;
+        std::println("{:<20}\t{:>12.0f}\t{:>9.2f}\t{:>10.2f}", OpName(op),
+                     num_ops / std::chrono::duration<double>(total).count(), calls_per_op, allocs_per_op);
+
+        auto limits = baseline.find(std::string(OpKey(op)));
+        if (limits == baseline.end())
+            continue;
+        if (calls_per_op > limits->second.calls) {
+            std::println(stderr, "{}: {:.2f} calls/op exceeds baseline of {:.2f}", OpName(op), calls_per_op,
+                         limits->second.calls);
+            result = 1;
+        }
+        if (allocs_per_op > limits->second.allocations) {
+            std::println(stderr, "{}: {:.2f} allocs/op exceeds baseline of {:.2f}", OpName(op), allocs_per_op,
+                         limits->second.allocations);
+            result = 1;
+        }
+    }
+
+    SetBackend(nullptr);
+    return result;
+}
+
+/// Settings for "serve" benchmark
+struct ServeOptions
+{
+    size_t num_requests = 1000;
+    size_t num_displays = 2;
+    double query_latency_ms = 0.05;
+};
+
+/// Latencies of individual requests
+struct RequestTimes
+{
+    std::vector<std::chrono::nanoseconds> times;
+    std::chrono::nanoseconds total {};
+};
+
+template<typename F> static RequestTimes TimeRequests(size_t num_requests, F request)
+{
+    RequestTimes result;
+    result.times.reserve(num_requests);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_requests; i++) {
+        auto request_start = std::chrono::steady_clock::now();
+        request();
+        result.times.push_back(std::chrono::steady_clock::now() - request_start);
+    }
+    result.total = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+static void PrintRequestTimes(std::string_view label, RequestTimes times)
+{
+    std::ranges::sort(times.times);
+    auto percentile = [&](double p) {
+        auto index = static_cast<size_t>(p * static_cast<double>(times.times.size() - 1));
+        return milliseconds_f(times.times[index]).count();
+    };
+    auto requests_per_s = static_cast<double>(times.times.size()) / std::chrono::duration<double>(times.total).count();
+    std::println("{:<32}\t{:>10.0f}\t{:>8.3f}\t{:>8.3f}", label, requests_per_s, percentile(0.5), percentile(0.99));
+}
+
+// Status of all displays as exit code, like "HDRCmd status -m x"
+static int StatusExitCode(hdr::Status status)
+{
+    switch (status) {
+    case hdr::Status::On:
+        return 0;
+    case hdr::Status::Off:
+        return 1;
+    case hdr::Status::Unsupported:
+        return 2;
+    }
+    return -1;
+}
+
+static constexpr std::string_view bench_endpoint = "hdr_bench";
+
+/**
+ * Compare status requests executed directly with a cold topology (as each HDRCmd invocation
+ * does) against requests sent to a server keeping the topology warm.
+ * Process creation isn't included, so the numbers understate the benefit of the server.
+ */
+static int BenchServe(const ServeOptions& options)
+{
+    SimulatedBackend backend(MakeExtendedTopology(options.num_displays));
+    backend.SetLatency(std::chrono::duration_cast<std::chrono::nanoseconds>(milliseconds_f(options.query_latency_ms)));
+    SetBackend(&backend);
+
+    auto listener = hdr::ipc::Listen(bench_endpoint);
+    if (!listener) {
+        std::println(stderr, "Failed to listen on IPC endpoint");
+        SetBackend(nullptr);
+        return 1;
+    }
+    std::thread server_thread([&]() {
+        hdr::ServeCommands(*listener, bench_endpoint, [](std::string_view) {
+            hdr::InvalidateStatus();
+            return hdr::CommandResult { StatusExitCode(hdr::GetWindowsHDRStatus()), {} };
+        });
+    });
+
+    std::println("{} request(s), {} display(s), {} ms per query", options.num_requests, options.num_displays,
+                 options.query_latency_ms);
+    std::println("{:<32}\t{:>10}\t{:>8}\t{:>8}", "Mode", "Requests/s", "p50, ms", "p99, ms");
+
+    PrintRequestTimes("direct, cold topology", TimeRequests(options.num_requests, []() {
+        hdr::InvalidateTopology();
+        StatusExitCode(hdr::GetWindowsHDRStatus());
+    }));
+    PrintRequestTimes("server, connection per request", TimeRequests(options.num_requests, []() {
+        if (auto connection = hdr::ipc::Connect(bench_endpoint))
+            hdr::SendCommand(*connection, "status");
+    }));
+    auto connection = hdr::ipc::Connect(bench_endpoint);
+    PrintRequestTimes("server, persistent connection", TimeRequests(options.num_requests, [&]() {
+        if (connection)
+            hdr::SendCommand(*connection, "status");
+    }));
+
+    // Stop the server, reusing the persistent connection if it could be established
+    if (!connection)
+        connection = hdr::ipc::Connect(bench_endpoint);
+    if (connection)
+        hdr::SendCommand(*connection, hdr::shutdown_command);
+    server_thread.join();
+    SetBackend(nullptr);
+    return 0;
+}
+
+/// Settings for "startup" benchmark
+struct StartupOptions
+{
+    size_t num_runs = 20;
+    std::vector<std::string> command;
+};
+
+/// Times measured for one process run
+struct ProcessTimes
+{
+    /// Time from starting the process to the first output
+    std::chrono::nanoseconds first_output {};
+    /// Time from starting the process to its exit
+    std::chrono::nanoseconds exit {};
+};
+
+#if defined(_WIN32)
+// Build a command line, quoting arguments containing spaces
+static std::wstring MakeCommandLine(const std::vector<std::string>& command)
+{
+    std::wstring command_line;
+    for (const auto& arg : command) {
+        if (!command_line.empty())
+            command_line.push_back(' ');
+        auto warg = CLI::widen(arg);
+        if (warg.find_first_of(L" \t") != std::wstring::npos)
+            command_line.append(std::format(L"\"{}\"", warg));
+        else
+            command_line.append(warg);
+    }
+    return command_line;
+}
+
+static std::optional<ProcessTimes> TimeProcess(const std::vector<std::string>& command)
+{
+    SECURITY_ATTRIBUTES inherit_attr = { sizeof(inherit_attr), nullptr, TRUE };
+    HANDLE read_pipe, write_pipe;
+    if (!CreatePipe(&read_pipe, &write_pipe, &inherit_attr, 0))
+        return std::nullopt;
+    SetHandleInformation(read_pipe, HANDLE_FLAG_INHERIT, 0);
+
+    STARTUPINFOW startup_info = { sizeof(startup_info) };
+    startup_info.dwFlags = STARTF_USESTDHANDLES;
+    startup_info.hStdOutput = write_pipe;
+    startup_info.hStdError = write_pipe;
+    startup_info.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    PROCESS_INFORMATION process_info;
+    auto command_line = MakeCommandLine(command);
+
+    ProcessTimes times;
+    auto start = std::chrono::steady_clock::now();
+    if (!CreateProcessW(nullptr, command_line.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup_info,
+                        &process_info)) {
+        CloseHandle(read_pipe);
+        CloseHandle(write_pipe);
+        return std::nullopt;
+    }
+    // Only the child should hold the write end, so reading ends when it exits
+    CloseHandle(write_pipe);
+
+    char buffer[4096];
+    DWORD num_read;
+    bool first = true;
+    while (ReadFile(read_pipe, buffer, sizeof(buffer), &num_read, nullptr) && num_read > 0) {
+        if (std::exchange(first, false))
+            times.first_output = std::chrono::steady_clock::now() - start;
+    }
+    WaitForSingleObject(process_info.hProcess, INFINITE);
+    times.exit = std::chrono::steady_clock::now() - start;
+
+    CloseHandle(process_info.hProcess);
+    CloseHandle(process_info.hThread);
+    CloseHandle(read_pipe);
+    return times;
+}
+#else
+static std::optional<ProcessTimes> TimeProcess(const std::vector<std::string>& command)
+{
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0)
+        return std::nullopt;
+
+    posix_spawn_file_actions_t file_actions;
+    posix_spawn_file_actions_init(&file_actions);
+    posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[1], STDERR_FILENO);
+    posix_spawn_file_actions_addclose(&file_actions, pipe_fds[0]);
+    posix_spawn_file_actions_addclose(&file_actions, pipe_fds[1]);
+
+    std::vector<char*> argv;
+    for (const auto& arg : command)
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    ProcessTimes times;
+    pid_t pid;
+    auto start = std::chrono::steady_clock::now();
+    int spawn_result = posix_spawnp(&pid, argv[0], &file_actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&file_actions);
+    close(pipe_fds[1]);
+    if (spawn_result != 0) {
+        close(pipe_fds[0]);
+        return std::nullopt;
+    }
+
+    char buffer[4096];
+    bool first = true;
+    while (read(pipe_fds[0], buffer, sizeof(buffer)) > 0) {
+        if (std::exchange(first, false))
+            times.first_output = std::chrono::steady_clock::now() - start;
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    times.exit = std::chrono::steady_clock::now() - start;
+    close(pipe_fds[0]);
+    return times;
+}
+#endif
+
+/**
+ * Measure the time from starting a process to its first output and to its exit.
+ * Includes process creation, as experienced by a script running the command.
+ */
+static int BenchStartup(const StartupOptions& options)
+{
+    RequestTimes first_output, exit;
+    for (size_t i = 0; i < options.num_runs; i++) {
+        auto times = TimeProcess(options.command);
+        if (!times) {
+            std::println(stderr, "Failed to run {}", options.command[0]);
+            return 1;
+        }
+        first_output.times.push_back(times->first_output);
+        // Both rates are based on the total time taken by the runs
+        first_output.total += times->exit;
+        exit.times.push_back(times->exit);
+        exit.total += times->exit;
+    }
+
+    std::string command_str;
+    for (const auto& arg : options.command)
+        command_str.append(command_str.empty() ? "" : " ").append(arg);
+    std::println("{} run(s) of: {}", options.num_runs, command_str);
+    std::println("{:<32}\t{:>10}\t{:>8}\t{:>8}", "Time to", "Runs/s", "p50, ms", "p99, ms");
+    PrintRequestTimes("first output", std::move(first_output));
+    PrintRequestTimes("exit", std::move(exit));
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "hdr_bench - benchmarks for hdr:: functions on a simulated display backend" };
+    app.require_subcommand(1);
+    int exit_code = 0;
+
+    SwitchOptions switch_options;
+    auto* switch_cmd = app.add_subcommand("switch", "Time switching HDR on, sequential vs parallel");
+    switch_cmd->add_option("-n,--max-displays", switch_options.max_displays, "Maximum number of displays")
+        ->check(CLI::Range(1, 64));
+    switch_cmd->add_option("-a,--adapters", switch_options.num_adapters, "Number of adapters")
+        ->check(CLI::Range(1, 64));
+    switch_cmd->add_option("--set-latency", switch_options.set_latency_ms, "Time per switch call, in ms");
+    switch_cmd->add_option("--query-latency", switch_options.query_latency_ms, "Time per other call, in ms");
+    switch_cmd->callback([&]() { BenchSwitch(switch_options); });
+
+    OpsOptions ops_options;
+    auto* ops_cmd = app.add_subcommand("ops", "Time hdr:: core operations, with calls and allocations per operation");
+    ops_cmd->add_option("-r,--ops", ops_options.num_ops, "Number of operations")->check(CLI::Range(1, 10000000));
+    ops_cmd->add_option("-d,--displays", ops_options.num_displays, "Number of displays")->check(CLI::Range(1, 64));
+    ops_cmd->add_option("-a,--adapters", ops_options.num_adapters, "Number of adapters")->check(CLI::Range(1, 64));
+    ops_cmd->add_option("--latency", ops_options.latency_ms, "Time per call, in ms");
+    ops_cmd->add_option("--failure-rate", ops_options.failure_rate, "Probability of a call failing")
+        ->check(CLI::Range(0.0, 1.0));
+    ops_cmd->add_option("--seed", ops_options.seed, "Seed for failures, to make runs reproducible");
+    ops_cmd->add_option("--topology", ops_options.topology, "Display topology: extended, clone, mixed or multipath")
+        ->transform(CLI::CheckedTransformer(std::map<std::string, Topology> { { "extended", Topology::Extended },
+                                                                              { "clone", Topology::Clone },
+                                                                              { "mixed", Topology::MixedClone },
+                                                                              { "multipath", Topology::MultiPath } },
+                                            CLI::ignore_case));
+    ops_cmd->add_option("--api", ops_options.api, "API generation: legacy or 24h2")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, hdr::ApiGeneration> { { "legacy", hdr::ApiGeneration::Legacy },
+                                                        { "24h2", hdr::ApiGeneration::Win11_24H2 } },
+            CLI::ignore_case));
+    ops_cmd->add_option("--invalidate", ops_options.invalidate, "Cache invalidation before each operation")
+        ->check(CLI::IsMember({ "none", "status", "topology", "hotplug" }));
+    ops_cmd->add_option("--op", ops_options.ops, "Operations to time (default: all)")
+        ->transform(CLI::CheckedTransformer(std::map<std::string, Op> { { "status", Op::Status },
+                                                                        { "displays", Op::Displays },
+                                                                        { "list", Op::DisplayList },
+                                                                        { "set", Op::Set },
+                                                                        { "toggle", Op::Toggle } },
+                                            CLI::ignore_case));
+    ops_cmd->add_option("--baseline", ops_options.baseline,
+                        "File with maximum calls and allocations per operation; fail if exceeded")
+        ->check(CLI::ExistingFile);
+    ops_cmd->callback([&]() { exit_code = BenchOps(ops_options); });
+
+    ServeOptions serve_options;
+    auto* serve_cmd = app.add_subcommand("serve", "Time status requests, direct vs through a command server");
+    serve_cmd->add_option("-r,--requests", serve_options.num_requests, "Number of requests")
+        ->check(CLI::Range(1, 1000000));
+    serve_cmd->add_option("-d,--displays", serve_options.num_displays, "Number of displays")
+        ->check(CLI::Range(1, 64));
+    serve_cmd->add_option("--query-latency", serve_options.query_latency_ms, "Time per call, in ms");
+    serve_cmd->callback([&]() { exit_code = BenchServe(serve_options); });
+
+    StartupOptions startup_options;
+    auto* startup_cmd = app.add_subcommand("startup", "Time process startup of a command, eg \"HDRCmd --help\"");
+    startup_cmd->add_option("-r,--runs", startup_options.num_runs, "Number of runs")->check(CLI::Range(1, 10000));
+    startup_cmd->add_option("command", startup_options.command, "Command to run, with arguments; put after \"--\"")
+        ->required();
+    startup_cmd->callback([&]() { exit_code = BenchStartup(startup_options); });
+
+    CLI11_PARSE(app, argc, argv);
+    return exit_code;
+}
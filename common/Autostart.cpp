@@ -0,0 +1,60 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Autostart.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <utility>
+
+namespace autostart {
+AutostartState::AutostartState(RunKey& key, std::wstring value_name, std::wstring command)
+    : key(key), value_name(std::move(value_name)), command(std::move(command))
+{
+}
+
+// Paths are case-insensitive
+static bool EqualsIgnoreCase(std::wstring_view a, std::wstring_view b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](wchar_t x, wchar_t y) { return std::towlower(x) == std::towlower(y); });
+}
+
+bool AutostartState::IsEnabled()
+{
+    stats.queries++;
+    if (key.CheckChanged())
+        enabled.reset();
+    if (!enabled) {
+        stats.reads++;
+        auto value = key.QueryValue(value_name);
+        enabled = value && EqualsIgnoreCase(*value, command);
+    }
+    return *enabled;
+}
+
+bool AutostartState::SetEnabled(bool enable)
+{
+    bool result = enable ? key.SetValue(value_name, command) : key.DeleteValue(value_name);
+    if (result)
+        enabled = enable;
+    else
+        enabled.reset();
+    return result;
+}
+} // namespace autostart
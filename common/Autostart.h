@@ -0,0 +1,92 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_AUTOSTART_H_
+#define COMMON_AUTOSTART_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace autostart {
+/// Access to the registry key listing programs to run on login
+class RunKey
+{
+public:
+    virtual ~RunKey() = default;
+
+    /// Read a string value. Not set if the value doesn't exist or is not a string
+    virtual std::optional<std::wstring> QueryValue(std::wstring_view name) = 0;
+    /// Set a string value
+    virtual bool SetValue(std::wstring_view name, std::wstring_view data) = 0;
+    /// Delete a value
+    virtual bool DeleteValue(std::wstring_view name) = 0;
+    /**
+     * Check whether the key may have changed since the last call.
+     * The first call always returns \c true.
+     */
+    virtual bool CheckChanged() = 0;
+};
+
+#if defined(_WIN32)
+/// Open the "Run" key of the current user
+std::unique_ptr<RunKey> OpenWin32RunKey();
+#endif
+
+/**
+ * Caches whether autostart is enabled.
+ * The registry is only read again when the key signals a change.
+ */
+class AutostartState
+{
+public:
+    struct Stats
+    {
+        /// Calls to IsEnabled()
+        uint64_t queries = 0;
+        /// Times the value was actually read from the key
+        uint64_t reads = 0;
+    };
+
+    /**
+     * Construct.
+     * \param key Key to store autostart value in.
+     * \param value_name Name of the autostart value.
+     * \param command Command stored in the autostart value.
+     */
+    AutostartState(RunKey& key, std::wstring value_name, std::wstring command);
+
+    /// Whether autostart is enabled, ie the key contains a value with the expected command
+    bool IsEnabled();
+    /// Enable or disable autostart
+    bool SetEnabled(bool enable);
+
+    const Stats& GetStats() const { return stats; }
+
+private:
+    RunKey& key;
+    std::wstring value_name;
+    std::wstring command;
+    std::optional<bool> enabled;
+    Stats stats;
+};
+} // namespace autostart
+
+#endif // COMMON_AUTOSTART_H_
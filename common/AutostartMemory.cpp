@@ -0,0 +1,65 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "AutostartMemory.h"
+
+#include <utility>
+
+namespace autostart {
+void MemoryRunKey::ExternalSetValue(std::wstring_view name, std::wstring_view data)
+{
+    values.insert_or_assign(std::wstring(name), std::wstring(data));
+    changed = true;
+}
+
+void MemoryRunKey::ExternalDeleteValue(std::wstring_view name)
+{
+    auto it = values.find(name);
+    if (it != values.end())
+        values.erase(it);
+    changed = true;
+}
+
+std::optional<std::wstring> MemoryRunKey::QueryValue(std::wstring_view name)
+{
+    stats.queries++;
+    auto it = values.find(name);
+    if (it == values.end())
+        return std::nullopt;
+    return it->second;
+}
+
+bool MemoryRunKey::SetValue(std::wstring_view name, std::wstring_view data)
+{
+    stats.sets++;
+    ExternalSetValue(name, data);
+    return true;
+}
+
+bool MemoryRunKey::DeleteValue(std::wstring_view name)
+{
+    stats.deletes++;
+    ExternalDeleteValue(name);
+    return true;
+}
+
+bool MemoryRunKey::CheckChanged()
+{
+    return std::exchange(changed, false);
+}
+} // namespace autostart
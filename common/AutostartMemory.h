@@ -0,0 +1,60 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_AUTOSTARTMEMORY_H_
+#define COMMON_AUTOSTARTMEMORY_H_
+
+#include "Autostart.h"
+
+#include <map>
+
+namespace autostart {
+/**
+ * In-memory "Run" key.
+ * Doesn't need any platform support; useful for testing and measuring.
+ */
+class MemoryRunKey : public RunKey
+{
+public:
+    struct Stats
+    {
+        uint64_t queries = 0;
+        uint64_t sets = 0;
+        uint64_t deletes = 0;
+    };
+
+    /// Change a value from "outside", as another program would
+    void ExternalSetValue(std::wstring_view name, std::wstring_view data);
+    /// Delete a value from "outside", as another program would
+    void ExternalDeleteValue(std::wstring_view name);
+
+    const Stats& GetStats() const { return stats; }
+
+    std::optional<std::wstring> QueryValue(std::wstring_view name) override;
+    bool SetValue(std::wstring_view name, std::wstring_view data) override;
+    bool DeleteValue(std::wstring_view name) override;
+    bool CheckChanged() override;
+
+private:
+    std::map<std::wstring, std::wstring, std::less<>> values;
+    bool changed = true;
+    Stats stats;
+};
+} // namespace autostart
+
+#endif // COMMON_AUTOSTARTMEMORY_H_
@@ -0,0 +1,131 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Autostart.h"
+
+#include "framework.h"
+
+namespace autostart {
+
+static const wchar_t run_key_path[] = L"Software\\Microsoft\\Windows\\CurrentVersion\\Run";
+
+namespace {
+/// "Run" key in the actual registry
+class Win32RunKey : public RunKey
+{
+    HKEY key = nullptr;
+    /// Signalled when the key changes
+    HANDLE change_event = nullptr;
+    bool notify_registered = false;
+
+    void RegisterNotify();
+
+public:
+    Win32RunKey();
+    ~Win32RunKey();
+
+    std::optional<std::wstring> QueryValue(std::wstring_view name) override;
+    bool SetValue(std::wstring_view name, std::wstring_view data) override;
+    bool DeleteValue(std::wstring_view name) override;
+    bool CheckChanged() override;
+};
+} // anonymous namespace
+
+Win32RunKey::Win32RunKey()
+{
+    if (RegCreateKeyExW(HKEY_CURRENT_USER, run_key_path, 0, nullptr, 0, KEY_READ | KEY_WRITE, nullptr, &key, nullptr)
+        != ERROR_SUCCESS) {
+        key = nullptr;
+        return;
+    }
+    change_event = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+}
+
+Win32RunKey::~Win32RunKey()
+{
+    // Closing the key also ends the change notification
+    if (key)
+        RegCloseKey(key);
+    if (change_event)
+        CloseHandle(change_event);
+}
+
+void Win32RunKey::RegisterNotify()
+{
+    ResetEvent(change_event);
+    notify_registered = RegNotifyChangeKeyValue(key, FALSE, REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC,
+                                                change_event, TRUE)
+                        == ERROR_SUCCESS;
+}
+
+std::optional<std::wstring> Win32RunKey::QueryValue(std::wstring_view name)
+{
+    if (!key)
+        return std::nullopt;
+
+    std::wstring name_str(name);
+    DWORD data_size = 0;
+    if (RegGetValueW(key, nullptr, name_str.c_str(), RRF_RT_REG_SZ, nullptr, nullptr, &data_size) != ERROR_SUCCESS)
+        return std::nullopt;
+    std::wstring data(data_size / sizeof(wchar_t), 0);
+    if (RegGetValueW(key, nullptr, name_str.c_str(), RRF_RT_REG_SZ, nullptr, data.data(), &data_size)
+        != ERROR_SUCCESS)
+        return std::nullopt;
+    // Strip terminator
+    data.resize(wcsnlen(data.c_str(), data.size()));
+    return data;
+}
+
+bool Win32RunKey::SetValue(std::wstring_view name, std::wstring_view data)
+{
+    if (!key)
+        return false;
+
+    std::wstring name_str(name);
+    std::wstring data_str(data);
+    return RegSetValueExW(key, name_str.c_str(), 0, REG_SZ, reinterpret_cast<const BYTE*>(data_str.c_str()),
+                          static_cast<DWORD>((data_str.size() + 1) * sizeof(wchar_t)))
+           == ERROR_SUCCESS;
+}
+
+bool Win32RunKey::DeleteValue(std::wstring_view name)
+{
+    if (!key)
+        return false;
+
+    std::wstring name_str(name);
+    return RegDeleteValueW(key, name_str.c_str()) == ERROR_SUCCESS;
+}
+
+bool Win32RunKey::CheckChanged()
+{
+    // Without a change notification, assume the key may always have changed
+    if (!key || !change_event)
+        return true;
+    if (notify_registered && WaitForSingleObject(change_event, 0) != WAIT_OBJECT_0)
+        return false;
+    RegisterNotify();
+    return true;
+}
+
+std::unique_ptr<RunKey> OpenWin32RunKey()
+{
+    return std::make_unique<Win32RunKey>();
+}
+
+} // namespace autostart
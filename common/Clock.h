@@ -0,0 +1,63 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_CLOCK_H_
+#define COMMON_CLOCK_H_
+
+#include <chrono>
+
+namespace hdr {
+/// Source of the current time, so time-dependent logic can be driven by a virtual clock
+class Clock
+{
+public:
+    using duration = std::chrono::steady_clock::duration;
+    using time_point = std::chrono::steady_clock::time_point;
+
+    virtual ~Clock() = default;
+
+    virtual time_point Now() const = 0;
+};
+
+/// Clock returning the actual (steady) time
+class SteadyClock : public Clock
+{
+public:
+    time_point Now() const override { return std::chrono::steady_clock::now(); }
+
+    /// Shared instance
+    static const SteadyClock& Get()
+    {
+        static SteadyClock clock;
+        return clock;
+    }
+};
+
+/// Clock only advancing when told so
+class VirtualClock : public Clock
+{
+    time_point now;
+
+public:
+    time_point Now() const override { return now; }
+
+    void Advance(duration amount) { now += amount; }
+};
+} // namespace hdr
+
+#endif // COMMON_CLOCK_H_
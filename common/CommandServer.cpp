@@ -0,0 +1,172 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "CommandServer.h"
+
+#include <charconv>
+#include <condition_variable>
+#include <format>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace hdr {
+
+static bool WriteResult(ipc::Connection& connection, const CommandResult& result)
+{
+    // Send header and output in one go
+    auto data = std::format("{} {}\n", result.exit_code, result.output.size());
+    data.append(result.output);
+    return connection.Write(data);
+}
+
+// Serve a single client. Returns whether the server should stop
+static bool ServeClient(ipc::Connection& connection, const CommandHandler& handler)
+{
+    std::string command;
+    while (connection.ReadLine(command)) {
+        if (command == shutdown_command) {
+            WriteResult(connection, CommandResult());
+            return true;
+        }
+        if (!WriteResult(connection, handler(command)))
+            break;
+    }
+    return false;
+}
+
+namespace {
+/// Client served on its own thread
+struct Client
+{
+    /// Taken by the client thread once serving is done, so it's only shut down while in use
+    std::unique_ptr<ipc::Connection> connection;
+    std::thread thread;
+    bool done = false;
+};
+
+/// Clients being served, shared with the client threads
+struct ServerState
+{
+    std::mutex mutex;
+    std::list<Client> clients;
+    bool stop = false;
+};
+} // anonymous namespace
+
+// Serve a client on the calling thread, then hand the client over for joining
+static void RunClient(ServerState& state, Client& client, std::string_view endpoint, const CommandHandler& handler)
+{
+    bool shutdown = ServeClient(*client.connection, handler);
+
+    std::unique_ptr<ipc::Connection> connection;
+    {
+        std::lock_guard lock(state.mutex);
+        connection = std::move(client.connection);
+        if (shutdown)
+            state.stop = true;
+    }
+    connection.reset();
+    // Wake up the listener waiting for a connection
+    if (shutdown)
+        ipc::Connect(endpoint);
+
+    std::lock_guard lock(state.mutex);
+    client.done = true;
+}
+
+// Join the threads of clients that were served
+static void JoinDoneClients(ServerState& state)
+{
+    std::list<Client> done_clients;
+    {
+        std::lock_guard lock(state.mutex);
+        for (auto it = state.clients.begin(); it != state.clients.end();) {
+            auto next = std::next(it);
+            if (it->done)
+                done_clients.splice(done_clients.end(), state.clients, it);
+            it = next;
+        }
+    }
+    for (auto& client : done_clients)
+        client.thread.join();
+}
+
+void ServeCommands(ipc::Listener& listener, std::string_view endpoint, const CommandHandler& handler)
+{
+    ServerState state;
+    while (auto connection = listener.Accept()) {
+        JoinDoneClients(state);
+
+        std::lock_guard lock(state.mutex);
+        if (state.stop)
+            break;
+        auto& client = state.clients.emplace_back();
+        client.connection = std::move(connection);
+        client.thread = std::thread(RunClient, std::ref(state), std::ref(client), endpoint, std::cref(handler));
+    }
+
+    /* Clients may be connected, but idle: waiting for them to send something could take forever,
+     * so shut their connections down. Commands that are executing still complete */
+    {
+        std::lock_guard lock(state.mutex);
+        state.stop = true;
+        for (auto& client : state.clients) {
+            if (client.connection)
+                client.connection->Shutdown();
+        }
+    }
+    // Only the calling thread changes the list, so it can be walked without the lock
+    for (auto& client : state.clients)
+        client.thread.join();
+}
+
+// Parse "<exit code> <output size>" line
+static bool ParseResultHeader(std::string_view line, int& exit_code, size_t& output_size)
+{
+    auto space = line.find(' ');
+    if (space == std::string_view::npos)
+        return false;
+    auto code_str = line.substr(0, space);
+    auto size_str = line.substr(space + 1);
+    auto code_result = std::from_chars(code_str.data(), code_str.data() + code_str.size(), exit_code);
+    auto size_result = std::from_chars(size_str.data(), size_str.data() + size_str.size(), output_size);
+    return code_result.ec == std::errc() && code_result.ptr == code_str.data() + code_str.size()
+        && size_result.ec == std::errc() && size_result.ptr == size_str.data() + size_str.size();
+}
+
+std::optional<CommandResult> SendCommand(ipc::Connection& connection, std::string_view command)
+{
+    // Commands are delimited by newlines, so they can't contain any
+    if (command.find_first_of("\r\n") != std::string_view::npos)
+        return std::nullopt;
+    if (!connection.Write(std::format("{}\n", command)))
+        return std::nullopt;
+
+    std::string header;
+    CommandResult result;
+    size_t output_size = 0;
+    if (!connection.ReadLine(header) || !ParseResultHeader(header, result.exit_code, output_size))
+        return std::nullopt;
+    if (!connection.Read(output_size, result.output))
+        return std::nullopt;
+    return result;
+}
+
+} // namespace hdr
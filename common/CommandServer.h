@@ -0,0 +1,68 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_COMMANDSERVER_H_
+#define COMMON_COMMANDSERVER_H_
+
+#include "Ipc.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace hdr {
+/**
+ * Line-based command protocol over an IPC connection.
+ *
+ * A request is a single line containing a command. The response is a line
+ * "<exit code> <output size>", followed by exactly <output size> bytes of output.
+ * A client may send any number of requests over one connection.
+ */
+
+/// Result of executing a command
+struct CommandResult
+{
+    int exit_code = 0;
+    /// Text output of the command
+    std::string output;
+};
+
+/// Executes a command on the server side. Called concurrently for different clients
+using CommandHandler = std::function<CommandResult(std::string_view command)>;
+
+/// Command that stops a server
+inline constexpr std::string_view shutdown_command = "shutdown";
+
+/**
+ * Serve commands on a listener.
+ * Each client is served on its own thread, so commands from different clients can meet, eg to
+ * combine HDR switches. Returns when a client sent the shutdown command, or accepting a connection
+ * failed, once the commands still executing completed. Other clients are disconnected.
+ * \param endpoint Name \a listener listens on. Used to wake up the listener on shutdown.
+ */
+void ServeCommands(ipc::Listener& listener, std::string_view endpoint, const CommandHandler& handler);
+
+/**
+ * Send a command to a server and wait for the result.
+ * Returns an empty optional if the command could not be sent or the connection broke.
+ */
+std::optional<CommandResult> SendCommand(ipc::Connection& connection, std::string_view command);
+} // namespace hdr
+
+#endif // COMMON_COMMANDSERVER_H_
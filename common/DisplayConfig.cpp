@@ -0,0 +1,142 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DisplayConfig.h"
+
+#include "Trace.h"
+
+namespace hdr::display_config {
+
+std::string_view CallName(Call call)
+{
+    switch (call) {
+    case Call::GetBufferSizes:
+        return "GetDisplayConfigBufferSizes";
+    case Call::QueryConfig:
+        return "QueryDisplayConfig";
+    case Call::GetAdvancedColorInfo:
+        return "GET_ADVANCED_COLOR_INFO";
+    case Call::GetAdvancedColorInfo2:
+        return "GET_ADVANCED_COLOR_INFO_2";
+    case Call::SetAdvancedColorState:
+        return "SET_ADVANCED_COLOR_STATE";
+    case Call::SetHdrState:
+        return "SET_HDR_STATE";
+    case Call::GetTargetName:
+        return "GET_TARGET_NAME";
+    case Call::GetTargetBaseType:
+        return "GET_TARGET_BASE_TYPE";
+    case Call::Count:
+        break;
+    }
+    return "???";
+}
+
+static bool Succeeded(bool result)
+{
+    return result;
+}
+
+static bool Succeeded(QueryResult result)
+{
+    return result == QueryResult::Success;
+}
+
+static bool Succeeded(CallResult result)
+{
+    return result == CallResult::Success;
+}
+
+template<typename F>
+auto Backend::Measure(Call call, const TargetId* target, F func)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto result = func();
+    auto duration = std::chrono::steady_clock::now() - start;
+
+    auto& call_counters = counters[static_cast<size_t>(call)];
+    call_counters.count.fetch_add(1, std::memory_order_relaxed);
+    if (!Succeeded(result))
+        call_counters.failures.fetch_add(1, std::memory_order_relaxed);
+    call_counters.total_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+                                     std::memory_order_relaxed);
+    if (trace::IsEnabled())
+        trace::Record(CallName(call), target, duration, !Succeeded(result));
+    return result;
+}
+
+bool Backend::GetBufferSizes(uint32_t& num_paths)
+{
+    return Measure(Call::GetBufferSizes, nullptr, [&]() { return DoGetBufferSizes(num_paths); });
+}
+
+QueryResult Backend::QueryConfig(std::span<Path> paths, uint32_t& num_paths)
+{
+    return Measure(Call::QueryConfig, nullptr, [&]() { return DoQueryConfig(paths, num_paths); });
+}
+
+bool Backend::GetAdvancedColorInfo(const TargetId& target, ColorInfo& info)
+{
+    return Measure(Call::GetAdvancedColorInfo, &target, [&]() { return DoGetAdvancedColorInfo(target, info); });
+}
+
+CallResult Backend::GetAdvancedColorInfo2(const TargetId& target, ColorInfo& info)
+{
+    return Measure(Call::GetAdvancedColorInfo2, &target, [&]() { return DoGetAdvancedColorInfo2(target, info); });
+}
+
+bool Backend::SetAdvancedColorState(const TargetId& target, bool enable)
+{
+    return Measure(Call::SetAdvancedColorState, &target, [&]() { return DoSetAdvancedColorState(target, enable); });
+}
+
+CallResult Backend::SetHdrState(const TargetId& target, bool enable)
+{
+    return Measure(Call::SetHdrState, &target, [&]() { return DoSetHdrState(target, enable); });
+}
+
+bool Backend::GetTargetName(const TargetId& target, TargetName& name)
+{
+    return Measure(Call::GetTargetName, &target, [&]() { return DoGetTargetName(target, name); });
+}
+
+bool Backend::GetTargetBaseType(const TargetId& target, bool& internal)
+{
+    return Measure(Call::GetTargetBaseType, &target, [&]() { return DoGetTargetBaseType(target, internal); });
+}
+
+CallStats Backend::GetStats(Call call) const
+{
+    const auto& call_counters = counters[static_cast<size_t>(call)];
+    CallStats stats;
+    stats.count = call_counters.count.load(std::memory_order_relaxed);
+    stats.failures = call_counters.failures.load(std::memory_order_relaxed);
+    stats.total_time = std::chrono::nanoseconds(call_counters.total_ns.load(std::memory_order_relaxed));
+    return stats;
+}
+
+void Backend::ResetStats()
+{
+    for (auto& call_counters : counters) {
+        call_counters.count.store(0, std::memory_order_relaxed);
+        call_counters.failures.store(0, std::memory_order_relaxed);
+        call_counters.total_ns.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace hdr::display_config
@@ -0,0 +1,185 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_DISPLAYCONFIG_H_
+#define COMMON_DISPLAYCONFIG_H_
+
+#include "HDR.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace hdr {
+/**
+ * Abstraction of the display configuration ("DisplayConfig") API.
+ * All calls go through a Backend, which keeps per-call statistics.
+ */
+namespace display_config {
+/// Kinds of calls into the display configuration API
+enum class Call
+{
+    /// GetDisplayConfigBufferSizes()
+    GetBufferSizes,
+    /// QueryDisplayConfig()
+    QueryConfig,
+    /// DISPLAYCONFIG_DEVICE_INFO_GET_ADVANCED_COLOR_INFO
+    GetAdvancedColorInfo,
+    /// DISPLAYCONFIG_DEVICE_INFO_GET_ADVANCED_COLOR_INFO_2
+    GetAdvancedColorInfo2,
+    /// DISPLAYCONFIG_DEVICE_INFO_SET_ADVANCED_COLOR_STATE
+    SetAdvancedColorState,
+    /// DISPLAYCONFIG_DEVICE_INFO_SET_HDR_STATE
+    SetHdrState,
+    /// DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_NAME
+    GetTargetName,
+    /// DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_BASE_TYPE
+    GetTargetBaseType,
+
+    Count
+};
+static constexpr size_t numCalls = static_cast<size_t>(Call::Count);
+
+/// Get a printable name for a call kind
+std::string_view CallName(Call call);
+
+/// An active display path
+struct Path
+{
+    /// Source of the path
+    SourceId source;
+    /// Target of the path
+    TargetId target;
+};
+
+/// HDR capability and state of a target
+struct ColorInfo
+{
+    bool hdr_supported = false;
+    bool hdr_enabled = false;
+};
+
+/// Target name information
+struct TargetName
+{
+    /// Monitor name. Only valid if friendly_name_from_edid is set.
+    wchar_t friendly_name[64] = {};
+    bool friendly_name_from_edid = false;
+    /// EDID manufacturer and product codes. Only valid if edid_ids_valid is set.
+    EdidId edid_ids;
+    bool edid_ids_valid = false;
+    /// Connector kind, a DISPLAYCONFIG_VIDEO_OUTPUT_TECHNOLOGY value
+    uint32_t output_technology = 0;
+    /// Instance of the connector kind on the adapter
+    uint32_t connector_instance = 0;
+};
+
+/// Result of a QueryConfig() call
+enum class QueryResult { Success, InsufficientBuffer, Failed };
+/// Result of a call that a display or driver may not support
+enum class CallResult { Success, NotSupported, Failed };
+
+/// Statistics for one kind of call
+struct CallStats
+{
+    /// Number of calls made
+    uint64_t count = 0;
+    /// Number of calls that failed
+    uint64_t failures = 0;
+    /// Cumulative time spent in calls
+    std::chrono::nanoseconds total_time {};
+};
+
+/**
+ * Display configuration API backend.
+ * Public methods measure and count the calls, the actual work is done by the protected
+ * Do*() methods implemented by subclasses. Statistics are safe to read from any thread.
+ * If tracing is enabled, calls are also recorded as trace spans, tagged with the target.
+ */
+class Backend
+{
+    struct Counters
+    {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> failures;
+        std::atomic<int64_t> total_ns;
+    };
+    std::array<Counters, numCalls> counters = {};
+
+    template<typename F>
+    auto Measure(Call call, const TargetId* target, F func);
+
+public:
+    virtual ~Backend() = default;
+
+    /// Whether GET_ADVANCED_COLOR_INFO_2 and SET_HDR_STATE are available (Windows 11 24H2 and up)
+    virtual bool HasHdrStateFunctions() const = 0;
+
+    /// Get the number of active paths
+    bool GetBufferSizes(uint32_t& num_paths);
+    /**
+     * Query active paths.
+     * \param paths Buffer receiving the paths.
+     * \param num_paths Receives the actual number of paths.
+     */
+    QueryResult QueryConfig(std::span<Path> paths, uint32_t& num_paths);
+    bool GetAdvancedColorInfo(const TargetId& target, ColorInfo& info);
+    CallResult GetAdvancedColorInfo2(const TargetId& target, ColorInfo& info);
+    bool SetAdvancedColorState(const TargetId& target, bool enable);
+    CallResult SetHdrState(const TargetId& target, bool enable);
+    bool GetTargetName(const TargetId& target, TargetName& name);
+    /// Query whether a target is an internal display
+    bool GetTargetBaseType(const TargetId& target, bool& internal);
+
+    /// Get statistics for a kind of call
+    CallStats GetStats(Call call) const;
+    /// Reset all statistics
+    void ResetStats();
+
+protected:
+    virtual bool DoGetBufferSizes(uint32_t& num_paths) = 0;
+    virtual QueryResult DoQueryConfig(std::span<Path> paths, uint32_t& num_paths) = 0;
+    virtual bool DoGetAdvancedColorInfo(const TargetId& target, ColorInfo& info) = 0;
+    virtual CallResult DoGetAdvancedColorInfo2(const TargetId& target, ColorInfo& info) = 0;
+    virtual bool DoSetAdvancedColorState(const TargetId& target, bool enable) = 0;
+    virtual CallResult DoSetHdrState(const TargetId& target, bool enable) = 0;
+    virtual bool DoGetTargetName(const TargetId& target, TargetName& name) = 0;
+    virtual bool DoGetTargetBaseType(const TargetId& target, bool& internal) = 0;
+};
+
+#if defined(_WIN32)
+/// Get backend using the actual Windows display configuration API
+Backend& GetWin32Backend();
+#endif
+
+/// Get the backend used by the hdr:: functions
+Backend& GetBackend();
+/**
+ * Set the backend used by the hdr:: functions.
+ * Pass \c nullptr to restore the default backend. There's only a default backend on Windows; elsewhere,
+ * a backend must be set before using the hdr:: functions.
+ * Invalidates the display topology.
+ */
+void SetBackend(Backend* backend);
+} // namespace display_config
+} // namespace hdr
+
+#endif // COMMON_DISPLAYCONFIG_H_
@@ -0,0 +1,302 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DisplayConfigSim.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace hdr::display_config {
+
+std::vector<SimulatedDisplay> MakeExtendedTopology(size_t num_displays, size_t num_adapters)
+{
+    std::vector<SimulatedDisplay> displays(num_displays);
+    for (size_t i = 0; i < num_displays; i++) {
+        auto& disp = displays[i];
+        disp.target.adapter.low = static_cast<uint32_t>(i % num_adapters) + 1;
+        disp.target.id = static_cast<uint32_t>(i) + 1;
+        disp.name = L"Display " + std::to_wstring(i + 1);
+        disp.connector_instance = static_cast<uint32_t>(i / num_adapters);
+    }
+    return displays;
+}
+
+std::vector<SimulatedDisplay> MakeCloneTopology(size_t num_displays, size_t num_adapters)
+{
+    auto displays = MakeExtendedTopology(num_displays, num_adapters);
+    for (auto& disp : displays)
+        disp.source = 0;
+    return displays;
+}
+
+std::vector<SimulatedDisplay> MakeMixedCloneTopology(size_t num_displays, size_t num_adapters)
+{
+    auto displays = MakeExtendedTopology(num_displays, num_adapters);
+    // Displays are distributed round-robin, so the n-th display on an adapter has index n * num_adapters + adapter
+    for (size_t i = 0; i < num_displays; i++)
+        displays[i].source = static_cast<uint32_t>(i / num_adapters / 2);
+    return displays;
+}
+
+std::vector<SimulatedDisplay> MakeMultiPathTopology(size_t num_displays, size_t num_adapters,
+                                                    uint32_t paths_per_display)
+{
+    auto displays = MakeExtendedTopology(num_displays, num_adapters);
+    for (auto& disp : displays)
+        disp.num_paths = paths_per_display;
+    return displays;
+}
+
+SimulatedBackend::SimulatedBackend(std::vector<SimulatedDisplay> displays) : displays(std::move(displays)) { }
+
+void SimulatedBackend::SetDisplays(std::vector<SimulatedDisplay> new_displays)
+{
+    std::lock_guard lock(mutex);
+    displays = std::move(new_displays);
+}
+
+std::vector<SimulatedDisplay> SimulatedBackend::GetDisplays() const
+{
+    std::lock_guard lock(mutex);
+    return displays;
+}
+
+void SimulatedBackend::QueueHotplug(std::vector<SimulatedDisplay> new_displays)
+{
+    std::lock_guard lock(mutex);
+    pending_hotplugs.emplace_back(std::move(new_displays));
+}
+
+void SimulatedBackend::SetHasHdrStateFunctions(bool flag)
+{
+    std::lock_guard lock(mutex);
+    has_hdr_state_functions = flag;
+}
+
+void SimulatedBackend::SetLatency(Call call, std::chrono::nanoseconds duration)
+{
+    std::lock_guard lock(mutex);
+    latency[static_cast<size_t>(call)] = duration;
+}
+
+void SimulatedBackend::SetLatency(std::chrono::nanoseconds duration)
+{
+    std::lock_guard lock(mutex);
+    latency.fill(duration);
+}
+
+void SimulatedBackend::SetFailureRate(Call call, double rate)
+{
+    std::lock_guard lock(mutex);
+    failure_rate[static_cast<size_t>(call)] = rate;
+}
+
+void SimulatedBackend::SetFailureRate(double rate)
+{
+    std::lock_guard lock(mutex);
+    failure_rate.fill(rate);
+}
+
+void SimulatedBackend::SetFailureSeed(uint32_t seed)
+{
+    std::lock_guard lock(mutex);
+    failure_rng.seed(seed);
+}
+
+bool SimulatedBackend::HasHdrStateFunctions() const
+{
+    std::lock_guard lock(mutex);
+    return has_hdr_state_functions;
+}
+
+const SimulatedDisplay* SimulatedBackend::FindDisplay(const TargetId& target) const
+{
+    auto it = std::find_if(displays.begin(), displays.end(),
+                           [&](const SimulatedDisplay& disp) { return disp.target == target; });
+    return it != displays.end() ? &*it : nullptr;
+}
+
+SimulatedDisplay* SimulatedBackend::FindDisplay(const TargetId& target)
+{
+    return const_cast<SimulatedDisplay*>(std::as_const(*this).FindDisplay(target));
+}
+
+// Count active paths. Must be called with the lock held
+uint32_t SimulatedBackend::CountPaths() const
+{
+    uint32_t total_paths = 0;
+    for (const auto& disp : displays)
+        total_paths += disp.num_paths;
+    return total_paths;
+}
+
+// Simulate time spent in a call. Sleeps without holding the lock, so calls may overlap
+void SimulatedBackend::Delay(Call call) const
+{
+    std::chrono::nanoseconds duration;
+    {
+        std::lock_guard lock(mutex);
+        duration = latency[static_cast<size_t>(call)];
+    }
+    if (duration.count() > 0)
+        std::this_thread::sleep_for(duration);
+}
+
+// Decide whether a call should fail. Must be called with the lock held
+bool SimulatedBackend::InjectFailure(Call call)
+{
+    double rate = failure_rate[static_cast<size_t>(call)];
+    if (rate <= 0)
+        return false;
+    // Use the engine output directly: unlike the distributions, it's exactly specified,
+    // so a seed gives the same failures with any standard library
+    auto range = static_cast<double>(failure_rng.max() - failure_rng.min()) + 1;
+    return static_cast<double>(failure_rng() - failure_rng.min()) < rate * range;
+}
+
+bool SimulatedBackend::DoGetBufferSizes(uint32_t& num_paths)
+{
+    Delay(Call::GetBufferSizes);
+    std::lock_guard lock(mutex);
+    if (InjectFailure(Call::GetBufferSizes))
+        return false;
+    num_paths = CountPaths();
+    if (!pending_hotplugs.empty()) {
+        displays = std::move(pending_hotplugs.front());
+        pending_hotplugs.pop_front();
+    }
+    return true;
+}
+
+QueryResult SimulatedBackend::DoQueryConfig(std::span<Path> out_paths, uint32_t& num_paths)
+{
+    Delay(Call::QueryConfig);
+    std::lock_guard lock(mutex);
+    if (InjectFailure(Call::QueryConfig))
+        return QueryResult::Failed;
+    uint32_t total_paths = CountPaths();
+    if (out_paths.size() < total_paths)
+        return QueryResult::InsufficientBuffer;
+
+    size_t path_index = 0;
+    for (const auto& disp : displays) {
+        Path path;
+        path.source.adapter = disp.target.adapter;
+        // Give displays without an explicit source their own, distinct from any explicit source id
+        path.source.id = disp.source.value_or(0x10000 + disp.target.id);
+        path.target = disp.target;
+        for (uint32_t i = 0; i < disp.num_paths; i++)
+            out_paths[path_index++] = path;
+    }
+    num_paths = total_paths;
+    return QueryResult::Success;
+}
+
+bool SimulatedBackend::DoGetAdvancedColorInfo(const TargetId& target, ColorInfo& info)
+{
+    Delay(Call::GetAdvancedColorInfo);
+    std::lock_guard lock(mutex);
+    if (InjectFailure(Call::GetAdvancedColorInfo))
+        return false;
+    const auto* disp = FindDisplay(target);
+    if (!disp)
+        return false;
+    info.hdr_supported = disp->hdr_supported;
+    info.hdr_enabled = disp->hdr_enabled;
+    return true;
+}
+
+CallResult SimulatedBackend::DoGetAdvancedColorInfo2(const TargetId& target, ColorInfo& info)
+{
+    Delay(Call::GetAdvancedColorInfo2);
+    std::lock_guard lock(mutex);
+    if (InjectFailure(Call::GetAdvancedColorInfo2))
+        return CallResult::Failed;
+    const auto* disp = FindDisplay(target);
+    if (!disp)
+        return CallResult::Failed;
+    if (!has_hdr_state_functions || !disp->hdr_state_functions)
+        return CallResult::NotSupported;
+    info.hdr_supported = disp->hdr_supported;
+    info.hdr_enabled = disp->hdr_enabled;
+    return CallResult::Success;
+}
+
+bool SimulatedBackend::DoSetAdvancedColorState(const TargetId& target, bool enable)
+{
+    Delay(Call::SetAdvancedColorState);
+    std::lock_guard lock(mutex);
+    if (InjectFailure(Call::SetAdvancedColorState))
+        return false;
+    auto* disp = FindDisplay(target);
+    if (!disp || !disp->hdr_supported)
+        return false;
+    disp->hdr_enabled = enable;
+    return true;
+}
+
+CallResult SimulatedBackend::DoSetHdrState(const TargetId& target, bool enable)
+{
+    Delay(Call::SetHdrState);
+    std::lock_guard lock(mutex);
+    if (InjectFailure(Call::SetHdrState))
+        return CallResult::Failed;
+    auto* disp = FindDisplay(target);
+    if (!disp || !disp->hdr_supported)
+        return CallResult::Failed;
+    if (!has_hdr_state_functions || !disp->hdr_state_functions)
+        return CallResult::NotSupported;
+    disp->hdr_enabled = enable;
+    return CallResult::Success;
+}
+
+bool SimulatedBackend::DoGetTargetName(const TargetId& target, TargetName& name)
+{
+    Delay(Call::GetTargetName);
+    std::lock_guard lock(mutex);
+    if (InjectFailure(Call::GetTargetName))
+        return false;
+    const auto* disp = FindDisplay(target);
+    if (!disp)
+        return false;
+    name = TargetName();
+    name.friendly_name_from_edid = !disp->name.empty();
+    auto num_copy = std::min(disp->name.size(), std::size(name.friendly_name) - 1);
+    std::copy_n(disp->name.data(), num_copy, name.friendly_name);
+    name.edid_ids_valid = disp->edid.has_value();
+    name.edid_ids = disp->edid.value_or(EdidId());
+    name.output_technology = disp->output_technology;
+    name.connector_instance = disp->connector_instance;
+    return true;
+}
+
+bool SimulatedBackend::DoGetTargetBaseType(const TargetId& target, bool& internal)
+{
+    Delay(Call::GetTargetBaseType);
+    std::lock_guard lock(mutex);
+    if (InjectFailure(Call::GetTargetBaseType))
+        return false;
+    const auto* disp = FindDisplay(target);
+    if (!disp)
+        return false;
+    internal = disp->internal;
+    return true;
+}
+
+} // namespace hdr::display_config
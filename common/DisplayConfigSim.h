@@ -0,0 +1,135 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_DISPLAYCONFIGSIM_H_
+#define COMMON_DISPLAYCONFIGSIM_H_
+
+#include "DisplayConfig.h"
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace hdr::display_config {
+/// A display in the simulated backend
+struct SimulatedDisplay
+{
+    TargetId target;
+    /**
+     * Id of the source shown on the display, on the target's adapter.
+     * Displays with the same source are clones. If not set, the display has its own source.
+     */
+    std::optional<uint32_t> source;
+    /// Number of active paths reporting the target
+    uint32_t num_paths = 1;
+    /// Name reported from "EDID". If empty, no EDID name is reported.
+    std::wstring name;
+    /// EDID codes. If not set, no EDID codes are reported.
+    std::optional<EdidId> edid;
+    /// Connector kind, a DISPLAYCONFIG_VIDEO_OUTPUT_TECHNOLOGY value
+    uint32_t output_technology = 0;
+    /// Instance of the connector kind on the adapter
+    uint32_t connector_instance = 0;
+    /// Whether the display reports as "internal"
+    bool internal = false;
+    bool hdr_supported = true;
+    bool hdr_enabled = false;
+    /// Whether GET_ADVANCED_COLOR_INFO_2 and SET_HDR_STATE work for this display
+    bool hdr_state_functions = true;
+};
+
+/**
+ * Make a topology of \a num_displays displays, distributed evenly over \a num_adapters adapters,
+ * each showing its own source ("extend" mode).
+ */
+std::vector<SimulatedDisplay> MakeExtendedTopology(size_t num_displays, size_t num_adapters = 1);
+/// Make a topology in which all displays on an adapter show the same source ("duplicate" mode)
+std::vector<SimulatedDisplay> MakeCloneTopology(size_t num_displays, size_t num_adapters = 1);
+/// Make a topology in which pairs of displays on an adapter show the same source
+std::vector<SimulatedDisplay> MakeMixedCloneTopology(size_t num_displays, size_t num_adapters = 1);
+/// Make a topology in which each display is reported on \a paths_per_display paths
+std::vector<SimulatedDisplay> MakeMultiPathTopology(size_t num_displays, size_t num_adapters,
+                                                    uint32_t paths_per_display);
+
+/**
+ * In-memory simulation of the display configuration API.
+ * Doesn't need any platform support; useful for testing and measuring.
+ */
+class SimulatedBackend : public Backend
+{
+    mutable std::mutex mutex;
+    std::vector<SimulatedDisplay> displays;
+    /// Topology changes applied after GetBufferSizes() calls
+    std::deque<std::vector<SimulatedDisplay>> pending_hotplugs;
+    bool has_hdr_state_functions = true;
+    std::array<std::chrono::nanoseconds, numCalls> latency = {};
+    std::array<double, numCalls> failure_rate = {};
+    std::minstd_rand failure_rng;
+
+    const SimulatedDisplay* FindDisplay(const TargetId& target) const;
+    SimulatedDisplay* FindDisplay(const TargetId& target);
+    uint32_t CountPaths() const;
+    void Delay(Call call) const;
+    bool InjectFailure(Call call);
+
+public:
+    SimulatedBackend() = default;
+    explicit SimulatedBackend(std::vector<SimulatedDisplay> displays);
+
+    /// Replace the simulated displays
+    void SetDisplays(std::vector<SimulatedDisplay> new_displays);
+    /// Get a copy of the simulated displays, reflecting any changes made through the backend
+    std::vector<SimulatedDisplay> GetDisplays() const;
+    /**
+     * Queue a topology change ("hot-plug") that is applied right after the next GetBufferSizes() call,
+     * so the following QueryConfig() sees a different topology than the reported buffer sizes.
+     * Changes queued multiple times are applied after consecutive GetBufferSizes() calls.
+     */
+    void QueueHotplug(std::vector<SimulatedDisplay> new_displays);
+
+    /// Set whether the simulated OS supports GET_ADVANCED_COLOR_INFO_2 and SET_HDR_STATE
+    void SetHasHdrStateFunctions(bool flag);
+    /// Set time a kind of call takes
+    void SetLatency(Call call, std::chrono::nanoseconds duration);
+    /// Set time all kinds of calls take
+    void SetLatency(std::chrono::nanoseconds duration);
+    /// Set probability (0..1) a kind of call fails. Failures are pseudo-random, but reproducible
+    void SetFailureRate(Call call, double rate);
+    /// Set probability (0..1) all kinds of calls fail
+    void SetFailureRate(double rate);
+    /// Restart the sequence of injected failures from \a seed
+    void SetFailureSeed(uint32_t seed);
+
+    bool HasHdrStateFunctions() const override;
+
+protected:
+    bool DoGetBufferSizes(uint32_t& num_paths) override;
+    QueryResult DoQueryConfig(std::span<Path> out_paths, uint32_t& num_paths) override;
+    bool DoGetAdvancedColorInfo(const TargetId& target, ColorInfo& info) override;
+    CallResult DoGetAdvancedColorInfo2(const TargetId& target, ColorInfo& info) override;
+    bool DoSetAdvancedColorState(const TargetId& target, bool enable) override;
+    CallResult DoSetHdrState(const TargetId& target, bool enable) override;
+    bool DoGetTargetName(const TargetId& target, TargetName& name) override;
+    bool DoGetTargetBaseType(const TargetId& target, bool& internal) override;
+};
+} // namespace hdr::display_config
+
+#endif // COMMON_DISPLAYCONFIGSIM_H_
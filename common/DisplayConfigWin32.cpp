@@ -0,0 +1,197 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DisplayConfig.h"
+
+#include <vector>
+
+#include "framework.h"
+#include "OsCapabilities.h"
+
+#if !defined(NTDDI_WIN11_GA) || WDK_NTDDI_VERSION < NTDDI_WIN11_GA
+#error Windows SDK too old: Version >= 10.0.26100 required
+#endif
+
+namespace hdr::display_config {
+
+namespace {
+/// Backend calling the actual Windows display configuration API
+class Win32Backend : public Backend
+{
+    // Mode count from the last DoGetBufferSizes() call
+    uint32_t num_modes = 0;
+    std::vector<DISPLAYCONFIG_PATH_INFO> paths;
+    std::vector<DISPLAYCONFIG_MODE_INFO> modes;
+
+public:
+    bool HasHdrStateFunctions() const override;
+
+protected:
+    bool DoGetBufferSizes(uint32_t& num_paths) override;
+    QueryResult DoQueryConfig(std::span<Path> out_paths, uint32_t& num_paths) override;
+    bool DoGetAdvancedColorInfo(const TargetId& target, ColorInfo& info) override;
+    CallResult DoGetAdvancedColorInfo2(const TargetId& target, ColorInfo& info) override;
+    bool DoSetAdvancedColorState(const TargetId& target, bool enable) override;
+    CallResult DoSetHdrState(const TargetId& target, bool enable) override;
+    bool DoGetTargetName(const TargetId& target, TargetName& name) override;
+    bool DoGetTargetBaseType(const TargetId& target, bool& internal) override;
+};
+} // anonymous namespace
+
+template<typename T>
+static void InitHeader(T& packet, DISPLAYCONFIG_DEVICE_INFO_TYPE type, const TargetId& target)
+{
+    packet.header.type = type;
+    packet.header.size = sizeof(packet);
+    packet.header.adapterId.HighPart = target.adapter.high;
+    packet.header.adapterId.LowPart = target.adapter.low;
+    packet.header.id = target.id;
+}
+
+bool Win32Backend::HasHdrStateFunctions() const
+{
+    return GetOsCapabilities().hdr_state_functions;
+}
+
+bool Win32Backend::DoGetBufferSizes(uint32_t& num_paths)
+{
+    return GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &num_paths, &num_modes) == ERROR_SUCCESS;
+}
+
+QueryResult Win32Backend::DoQueryConfig(std::span<Path> out_paths, uint32_t& num_paths)
+{
+    uint32_t pathCount = static_cast<uint32_t>(out_paths.size());
+    uint32_t modeCount = num_modes;
+    // Buffers are kept between calls and only grow, so repeated queries don't allocate
+    if (paths.size() < pathCount)
+        paths.resize(pathCount);
+    if (modes.size() < modeCount)
+        modes.resize(modeCount);
+
+    auto result = QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &pathCount, paths.data(), &modeCount, modes.data(), 0);
+    if (result == ERROR_INSUFFICIENT_BUFFER)
+        return QueryResult::InsufficientBuffer;
+    else if (result != ERROR_SUCCESS)
+        return QueryResult::Failed;
+
+    for (uint32_t i = 0; i < pathCount; i++) {
+        out_paths[i].source.adapter.low = paths[i].sourceInfo.adapterId.LowPart;
+        out_paths[i].source.adapter.high = paths[i].sourceInfo.adapterId.HighPart;
+        out_paths[i].source.id = paths[i].sourceInfo.id;
+        /* Take the target from the path itself: the mode index may be
+         * DISPLAYCONFIG_PATH_MODE_IDX_INVALID, eg for paths in clone mode */
+        out_paths[i].target.adapter.low = paths[i].targetInfo.adapterId.LowPart;
+        out_paths[i].target.adapter.high = paths[i].targetInfo.adapterId.HighPart;
+        out_paths[i].target.id = paths[i].targetInfo.id;
+    }
+    num_paths = pathCount;
+    return QueryResult::Success;
+}
+
+bool Win32Backend::DoGetAdvancedColorInfo(const TargetId& target, ColorInfo& info)
+{
+    DISPLAYCONFIG_GET_ADVANCED_COLOR_INFO getColorInfo = {};
+    InitHeader(getColorInfo, DISPLAYCONFIG_DEVICE_INFO_GET_ADVANCED_COLOR_INFO, target);
+    if (DisplayConfigGetDeviceInfo(&getColorInfo.header) != ERROR_SUCCESS)
+        return false;
+
+    info.hdr_supported = getColorInfo.advancedColorSupported;
+    info.hdr_enabled = getColorInfo.advancedColorEnabled;
+    return true;
+}
+
+// Distinguish a call the display or driver doesn't support from other failures
+static CallResult ToCallResult(LONG error)
+{
+    switch (error) {
+    case ERROR_SUCCESS:
+        return CallResult::Success;
+    case ERROR_NOT_SUPPORTED:
+    case ERROR_INVALID_PARAMETER:
+        return CallResult::NotSupported;
+    }
+    return CallResult::Failed;
+}
+
+CallResult Win32Backend::DoGetAdvancedColorInfo2(const TargetId& target, ColorInfo& info)
+{
+    DISPLAYCONFIG_GET_ADVANCED_COLOR_INFO_2 getColorInfo2 = {};
+    InitHeader(getColorInfo2, DISPLAYCONFIG_DEVICE_INFO_GET_ADVANCED_COLOR_INFO_2, target);
+    auto result = ToCallResult(DisplayConfigGetDeviceInfo(&getColorInfo2.header));
+    if (result != CallResult::Success)
+        return result;
+
+    info.hdr_supported = getColorInfo2.highDynamicRangeSupported;
+    // Only DISPLAYCONFIG_ADVANCED_COLOR_MODE_HDR is true HDR.
+    info.hdr_enabled = getColorInfo2.activeColorMode == DISPLAYCONFIG_ADVANCED_COLOR_MODE_HDR;
+    return CallResult::Success;
+}
+
+bool Win32Backend::DoSetAdvancedColorState(const TargetId& target, bool enable)
+{
+    DISPLAYCONFIG_SET_ADVANCED_COLOR_STATE setColorState = {};
+    InitHeader(setColorState, DISPLAYCONFIG_DEVICE_INFO_SET_ADVANCED_COLOR_STATE, target);
+    setColorState.enableAdvancedColor = enable;
+    return DisplayConfigSetDeviceInfo(&setColorState.header) == ERROR_SUCCESS;
+}
+
+CallResult Win32Backend::DoSetHdrState(const TargetId& target, bool enable)
+{
+    DISPLAYCONFIG_SET_HDR_STATE setHdrState = {};
+    InitHeader(setHdrState, DISPLAYCONFIG_DEVICE_INFO_SET_HDR_STATE, target);
+    setHdrState.enableHdr = enable;
+    return ToCallResult(DisplayConfigSetDeviceInfo(&setHdrState.header));
+}
+
+bool Win32Backend::DoGetTargetName(const TargetId& target, TargetName& name)
+{
+    DISPLAYCONFIG_TARGET_DEVICE_NAME deviceName = {};
+    InitHeader(deviceName, DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_NAME, target);
+    if (DisplayConfigGetDeviceInfo(&deviceName.header) != ERROR_SUCCESS)
+        return false;
+
+    name.friendly_name_from_edid = deviceName.flags.friendlyNameFromEdid;
+    static_assert(sizeof(name.friendly_name) == sizeof(deviceName.monitorFriendlyDeviceName));
+    memcpy(name.friendly_name, deviceName.monitorFriendlyDeviceName, sizeof(name.friendly_name));
+    name.edid_ids_valid = deviceName.flags.edidIdsValid;
+    name.edid_ids.manufacturer = deviceName.edidManufactureId;
+    name.edid_ids.product = deviceName.edidProductCodeId;
+    name.output_technology = static_cast<uint32_t>(deviceName.outputTechnology);
+    name.connector_instance = deviceName.connectorInstance;
+    return true;
+}
+
+bool Win32Backend::DoGetTargetBaseType(const TargetId& target, bool& internal)
+{
+    DISPLAYCONFIG_TARGET_BASE_TYPE target_base = {};
+    InitHeader(target_base, DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_BASE_TYPE, target);
+    if (DisplayConfigGetDeviceInfo(&target_base.header) != ERROR_SUCCESS)
+        return false;
+
+    internal = (target_base.baseOutputTechnology != DISPLAYCONFIG_OUTPUT_TECHNOLOGY_OTHER)
+        && (target_base.baseOutputTechnology & DISPLAYCONFIG_OUTPUT_TECHNOLOGY_INTERNAL);
+    return true;
+}
+
+Backend& GetWin32Backend()
+{
+    static Win32Backend backend;
+    return backend;
+}
+
+} // namespace hdr::display_config
@@ -0,0 +1,139 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DisplayIndex.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <functional>
+
+namespace hdr {
+
+static size_t HashCombine(size_t seed, size_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+// Names are looked up ignoring case
+static std::wstring FoldCase(std::wstring_view name)
+{
+    std::wstring folded(name);
+    std::ranges::transform(folded, folded.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+    return folded;
+}
+
+size_t DisplayIndex::Hash::operator()(const TargetId& id) const
+{
+    auto luid = (static_cast<uint64_t>(static_cast<uint32_t>(id.adapter.high)) << 32) | id.adapter.low;
+    return HashCombine(std::hash<uint64_t>()(luid), std::hash<uint32_t>()(id.id));
+}
+
+size_t DisplayIndex::Hash::operator()(const Connector& connector) const
+{
+    auto luid = (static_cast<uint64_t>(static_cast<uint32_t>(connector.adapter.high)) << 32) | connector.adapter.low;
+    auto kind = (static_cast<uint64_t>(connector.output_technology) << 32) | connector.instance;
+    return HashCombine(std::hash<uint64_t>()(luid), std::hash<uint64_t>()(kind));
+}
+
+bool DisplayIndex::Update()
+{
+    // Fetch generation first: a topology change while querying will cause another update
+    auto current_generation = GetTopologyGeneration();
+    if (valid && generation == current_generation)
+        return false;
+
+    generation = current_generation;
+    valid = true;
+    return Update(GetDisplayIdentities());
+}
+
+bool DisplayIndex::Update(std::vector<DisplayIdentity> identities)
+{
+    std::vector<TargetId> new_reported_order(identities.size());
+    std::ranges::transform(identities, new_reported_order.begin(), &DisplayIdentity::id);
+    std::ranges::sort(identities, {}, &DisplayIdentity::id);
+    if (identities == entries && new_reported_order == reported_order)
+        return false;
+
+    entries = std::move(identities);
+    reported_order = std::move(new_reported_order);
+    Rebuild();
+    return true;
+}
+
+void DisplayIndex::Rebuild()
+{
+    by_id.clear();
+    by_connector.clear();
+    by_name.clear();
+    folded_names.clear();
+    name_order.clear();
+    by_index.clear();
+
+    by_id.reserve(entries.size());
+    by_connector.reserve(entries.size());
+    folded_names.reserve(entries.size());
+    name_order.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        by_id.emplace(entries[i].id, i);
+        by_connector.emplace(entries[i].connector, i);
+        folded_names.push_back(FoldCase(entries[i].name));
+        name_order.push_back(&entries[i]);
+    }
+
+    // Group by name; stable sort keeps target id order within a group
+    auto get_name = [this](const DisplayIdentity* entry) {
+        return std::wstring_view(folded_names[static_cast<size_t>(entry - entries.data())]);
+    };
+    std::ranges::stable_sort(name_order, {}, get_name);
+    for (size_t i = 0; i < name_order.size(); i++) {
+        auto [it, inserted] = by_name.try_emplace(get_name(name_order[i]), NameRange { i, 0 });
+        it->second.count++;
+    }
+
+    by_index.reserve(reported_order.size());
+    for (const auto& id : reported_order)
+        by_index.push_back(by_id.at(id));
+}
+
+const DisplayIdentity* DisplayIndex::FindById(const TargetId& id) const
+{
+    auto it = by_id.find(id);
+    return it != by_id.end() ? &entries[it->second] : nullptr;
+}
+
+std::span<const DisplayIdentity* const> DisplayIndex::FindByName(std::wstring_view name) const
+{
+    auto it = by_name.find(FoldCase(name));
+    if (it == by_name.end())
+        return {};
+    return std::span(name_order).subspan(it->second.begin, it->second.count);
+}
+
+const DisplayIdentity* DisplayIndex::FindByConnector(const Connector& connector) const
+{
+    auto it = by_connector.find(connector);
+    return it != by_connector.end() ? &entries[it->second] : nullptr;
+}
+
+const DisplayIdentity* DisplayIndex::FindByIndex(size_t index) const
+{
+    return index < by_index.size() ? &entries[by_index[index]] : nullptr;
+}
+
+} // namespace hdr
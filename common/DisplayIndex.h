@@ -0,0 +1,106 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_DISPLAYINDEX_H_
+#define COMMON_DISPLAYINDEX_H_
+
+#include "HDR.h"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace hdr {
+/**
+ * Index over the identities of the connected displays, for constant-time lookups by
+ * target id, name, connector or index.
+ *
+ * Entries are ordered by target id, independent of the order the system reports display
+ * paths in. An update that finds the same displays, reported in the same order, leaves the
+ * index untouched, so pointers and spans obtained from it remain valid.
+ *
+ * Not thread-safe; users need to synchronize access themselves.
+ */
+class DisplayIndex
+{
+public:
+    /**
+     * Update the index from the current display topology.
+     * Does nothing if the topology generation didn't change since the last update.
+     * \returns Whether the displays or their order changed.
+     */
+    bool Update();
+    /**
+     * Update the index from a list of display identities, in the order the system reports them.
+     * \returns Whether the displays or their order changed.
+     */
+    bool Update(std::vector<DisplayIdentity> identities);
+
+    /// All displays, ordered by target id
+    std::span<const DisplayIdentity> GetDisplays() const { return entries; }
+
+    /// Find a display by target id. Returns \c nullptr if there is no such display
+    const DisplayIdentity* FindById(const TargetId& id) const;
+    /// Find displays by name, ignoring case. Multiple displays may share the same name
+    std::span<const DisplayIdentity* const> FindByName(std::wstring_view name) const;
+    /// Find the display attached to a connector. Returns \c nullptr if there is no such display
+    const DisplayIdentity* FindByConnector(const Connector& connector) const;
+    /**
+     * Find a display by its position in the order the system reports displays,
+     * as in DisplayRef::index. Returns \c nullptr if there is no such display
+     */
+    const DisplayIdentity* FindByIndex(size_t index) const;
+
+private:
+    struct Hash
+    {
+        size_t operator()(const TargetId& id) const;
+        size_t operator()(const Connector& connector) const;
+    };
+    /// Range of entries in name_order
+    struct NameRange
+    {
+        size_t begin;
+        size_t count;
+    };
+
+    std::vector<DisplayIdentity> entries;
+    /// Target ids in the order the system reported them
+    std::vector<TargetId> reported_order;
+    /// Topology generation the index was last updated at
+    uint64_t generation = 0;
+    bool valid = false;
+
+    std::unordered_map<TargetId, size_t, Hash> by_id;
+    std::unordered_map<Connector, size_t, Hash> by_connector;
+    /// Lower-cased names, parallel to entries
+    std::vector<std::wstring> folded_names;
+    /// Keys point into folded_names
+    std::unordered_map<std::wstring_view, NameRange> by_name;
+    /// Entries grouped by name
+    std::vector<const DisplayIdentity*> name_order;
+    /// Indices of entries in reported order
+    std::vector<size_t> by_index;
+
+    void Rebuild();
+};
+} // namespace hdr
+
+#endif // COMMON_DISPLAYINDEX_H_
@@ -0,0 +1,115 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "DisplayList.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+
+namespace hdr {
+
+// Entries are placed into raw storage and never destroyed
+static_assert(std::is_trivially_destructible_v<DisplayEntry>);
+static_assert(alignof(DisplayEntry) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+/// Maximum number of UTF-8 code units needed per wchar_t code unit
+static constexpr size_t maxUtf8PerWchar = sizeof(wchar_t) == 2 ? 3 : 4;
+
+// Decode the next code point from a wchar_t string; unpaired surrogates decode as U+FFFD
+static char32_t DecodeNext(std::wstring_view str, size_t& pos)
+{
+    char32_t c = static_cast<char32_t>(str[pos++]);
+    if constexpr (sizeof(wchar_t) == 2) {
+        if (c >= 0xd800 && c < 0xdc00 && pos < str.size()) {
+            char32_t low = static_cast<char32_t>(str[pos]);
+            if (low >= 0xdc00 && low < 0xe000) {
+                pos++;
+                return 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+            }
+        }
+    }
+    if ((c >= 0xd800 && c < 0xe000) || c > 0x10ffff)
+        return 0xfffd;
+    return c;
+}
+
+// Encode a wchar_t string as UTF-8. Returns the end of the encoded string
+static char* EncodeUtf8(std::wstring_view str, char* out)
+{
+    size_t pos = 0;
+    while (pos < str.size()) {
+        char32_t c = DecodeNext(str, pos);
+        if (c < 0x80) {
+            *out++ = static_cast<char>(c);
+        } else if (c < 0x800) {
+            *out++ = static_cast<char>(0xc0 | (c >> 6));
+            *out++ = static_cast<char>(0x80 | (c & 0x3f));
+        } else if (c < 0x10000) {
+            *out++ = static_cast<char>(0xe0 | (c >> 12));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (c & 0x3f));
+        } else {
+            *out++ = static_cast<char>(0xf0 | (c >> 18));
+            *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            *out++ = static_cast<char>(0x80 | (c & 0x3f));
+        }
+    }
+    return out;
+}
+
+void DisplayList::Reset(size_t num_displays, size_t num_name_chars)
+{
+    // Layout: entries, UTF-16 names, UTF-8 names. Each region is suitably aligned for the next
+    size_t entries_size = num_displays * sizeof(DisplayEntry);
+    size_t wide_size = num_name_chars * sizeof(wchar_t);
+    size_t utf8_size = num_name_chars * maxUtf8PerWchar;
+    size_t needed_size = entries_size + wide_size + utf8_size;
+    if (needed_size > buffer_size) {
+        buffer = std::make_unique_for_overwrite<std::byte[]>(needed_size);
+        buffer_size = needed_size;
+    }
+
+    max_entries = num_displays;
+    num_entries = 0;
+    wide_pos = reinterpret_cast<wchar_t*>(buffer.get() + entries_size);
+    wide_end = wide_pos + num_name_chars;
+    utf8_pos = reinterpret_cast<char*>(wide_end);
+    utf8_end = utf8_pos + utf8_size;
+}
+
+void DisplayList::Add(const DisplayEntry& entry, std::wstring_view name)
+{
+    assert(num_entries < max_entries);
+    assert(static_cast<size_t>(wide_end - wide_pos) >= name.size());
+
+    auto* new_entry = std::construct_at(GetEntryStorage() + num_entries, entry);
+    num_entries++;
+
+    new_entry->name = std::wstring_view(wide_pos, name.size());
+    wide_pos = std::ranges::copy(name, wide_pos).out;
+
+    char* utf8_start = utf8_pos;
+    utf8_pos = EncodeUtf8(name, utf8_pos);
+    assert(utf8_pos <= utf8_end);
+    new_entry->name_utf8 = std::string_view(utf8_start, utf8_pos);
+}
+
+} // namespace hdr
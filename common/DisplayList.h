@@ -0,0 +1,97 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_DISPLAYLIST_H_
+#define COMMON_DISPLAYLIST_H_
+
+#include "HDR.h"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace hdr {
+/// Display information stored in a DisplayList. Names point into the list's storage
+struct DisplayEntry
+{
+    /// Display name, UTF-16
+    std::wstring_view name;
+    /// Display name, UTF-8
+    std::string_view name_utf8;
+    /// HDR status
+    Status status;
+    /// Display target
+    TargetId id;
+    /// EDID codes, if the display reported them
+    std::optional<EdidId> edid;
+    /// Connector the display is attached to
+    Connector connector;
+    /// API generation used to query the HDR status
+    ApiGeneration api = ApiGeneration::Unknown;
+    /// Clone group of the display, see Display::clone_group
+    std::optional<size_t> clone_group;
+};
+
+/**
+ * List of displays, stored in a single buffer: the entries, followed by all names,
+ * in UTF-16 and UTF-8.
+ * The buffer only grows, so a list reused across GetDisplays() calls doesn't allocate
+ * once it has seen the largest topology. Views into the list stay valid until it's refilled.
+ */
+class DisplayList
+{
+    std::unique_ptr<std::byte[]> buffer;
+    size_t buffer_size = 0;
+    size_t max_entries = 0;
+    size_t num_entries = 0;
+    /// Next free UTF-16 resp. UTF-8 name storage
+    wchar_t* wide_pos = nullptr;
+    wchar_t* wide_end = nullptr;
+    char* utf8_pos = nullptr;
+    char* utf8_end = nullptr;
+
+    DisplayEntry* GetEntryStorage() const { return reinterpret_cast<DisplayEntry*>(buffer.get()); }
+
+public:
+    DisplayList() = default;
+    DisplayList(DisplayList&&) = default;
+    DisplayList& operator=(DisplayList&&) = default;
+
+    /**
+     * Remove all displays and make room for new ones.
+     * \param num_displays Maximum number of displays to be added.
+     * \param num_name_chars Maximum total length of the names, in UTF-16 code units.
+     */
+    void Reset(size_t num_displays, size_t num_name_chars);
+    /// Add a display. Reset() must have made room for it
+    void Add(const DisplayEntry& entry, std::wstring_view name);
+
+    std::span<const DisplayEntry> GetDisplays() const { return { GetEntryStorage(), num_entries }; }
+    /// Size of the underlying buffer, in bytes
+    size_t GetBufferSize() const { return buffer_size; }
+};
+
+/**
+ * Get information for all displays, or the ones selected by a filter, into a list.
+ * Any previous contents of the list are replaced.
+ */
+void GetDisplays(DisplayList& list, const DisplayFilter& filter = {});
+} // namespace hdr
+
+#endif // COMMON_DISPLAYLIST_H_
@@ -9,83 +9,292 @@
 
 #include "HDR.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <span>
 #include <string>
+#include <thread>
 #include <vector>
 
-#include "framework.h"
-#include "WinVerCheck.hpp"
-
-#if !defined(NTDDI_WIN11_GA) || WDK_NTDDI_VERSION < NTDDI_WIN11_GA
-#error Windows SDK too old: Version >= 10.0.26100 required
-#endif
+#include "DisplayConfig.h"
+#include "DisplayList.h"
 
 namespace hdr {
 
-static const bool use_win11_24h2_color_functions = IsWindows11_24H2OrGreater();
+using display_config::Backend;
 
-template<typename F> static void ForEachDisplay(F func)
+namespace {
+/// Display name and identifying information of a target
+struct TargetDescription
+{
+    /// Display name. Empty if the name could not be queried
+    std::wstring name;
+    std::optional<EdidId> edid;
+    Connector connector;
+};
+
+/// Cached information about a single display target
+struct Target
+{
+    TargetId id;
+    /// Source shown on the target
+    SourceId source;
+    /// Clone group, if other targets show the same source
+    std::optional<size_t> clone_group;
+    /**
+     * API generations that worked for this target, for querying resp. setting the HDR status.
+     * Avoids trying functions again that are known to fail.
+     */
+    ApiGeneration query_api = ApiGeneration::Unknown;
+    ApiGeneration set_api = ApiGeneration::Unknown;
+    /// HDR status, if already queried
+    std::optional<Status> status;
+    /// Status generation the status was queried at
+    uint64_t status_generation = 0;
+    /// Display name and identifying information, if already queried
+    std::optional<TargetDescription> description;
+    /// Whether querying the description failed. It's queried again on the next GetTargets()
+    bool description_failed = false;
+};
+
+/**
+ * Snapshot of the display topology.
+ * Keeps the active paths and per-target information obtained from the backend, so repeated
+ * queries don't need to go to the driver.
+ * The snapshot is re-queried when the topology generation changes.
+ */
+class Topology
 {
+    /// Number of attempts to query the paths if the topology keeps changing during the query
+    static constexpr int max_query_attempts = 4;
+
+    std::vector<display_config::Path> paths;
+    std::vector<Target> targets;
+    /// Generation the snapshot was taken at
+    uint64_t generation = 0;
+    bool valid = false;
+
+    bool Query(Backend& backend);
+
+public:
+    /**
+     * Get targets, re-querying the topology if the generation changed.
+     * Descriptions that couldn't be queried are forgotten, so they're tried again.
+     */
+    std::span<Target> GetTargets(Backend& backend, uint64_t current_generation);
+};
+} // anonymous namespace
+
+static std::atomic<uint64_t> topology_generation;
+static std::atomic<uint64_t> status_generation;
+static std::mutex topology_mutex;
+static Topology topology;
+static Backend* current_backend;
+
+/// Maximum number of threads used when switching concurrently
+static constexpr size_t max_switch_workers = 4;
+
+// Query the topology. Returns whether that succeeded; on failure, the snapshot is empty
+bool Topology::Query(Backend& backend)
+{
+    // Buffers only ever grow, so re-querying an unchanged topology doesn't allocate
+    paths.clear();
+    targets.clear();
+
+    /* The topology may change between getting the buffer sizes and querying, eg when
+     * a display is plugged in. In that case, get the new sizes and try again */
     uint32_t pathCount = 0;
-    uint32_t modeCount = 0;
+    auto result = display_config::QueryResult::InsufficientBuffer;
+    for (int attempt = 0; attempt < max_query_attempts && result == display_config::QueryResult::InsufficientBuffer;
+         attempt++) {
+        if (!backend.GetBufferSizes(pathCount))
+            return false;
+        paths.resize(pathCount);
+        result = backend.QueryConfig(paths, pathCount);
+    }
+    if (result != display_config::QueryResult::Success) {
+        paths.clear();
+        return false;
+    }
+    paths.resize(pathCount);
 
-    if (GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &pathCount, &modeCount) != ERROR_SUCCESS)
-        return;
+    targets.reserve(paths.size());
+    for (const auto& path : paths) {
+        /* Some setups report a target on multiple paths. Only keep the first, so each
+         * target is queried and switched once */
+        auto existing = std::ranges::find(targets, path.target, &Target::id);
+        if (existing != targets.end())
+            continue;
+
+        Target new_target;
+        new_target.id = path.target;
+        new_target.source = path.source;
+        targets.emplace_back(std::move(new_target));
+    }
 
-    std::vector<DISPLAYCONFIG_PATH_INFO> paths(pathCount);
-    std::vector<DISPLAYCONFIG_MODE_INFO> modes(modeCount);
+    // Targets showing the same source are clones of each other
+    size_t num_clone_groups = 0;
+    for (auto it = targets.begin(); it != targets.end(); ++it) {
+        if (it->clone_group)
+            continue;
+        bool has_clones = false;
+        for (auto other = std::next(it); other != targets.end(); ++other) {
+            if (other->source == it->source) {
+                other->clone_group = num_clone_groups;
+                has_clones = true;
+            }
+        }
+        if (has_clones)
+            it->clone_group = num_clone_groups++;
+    }
+    return true;
+}
 
-    if (QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &pathCount, paths.data(), &modeCount, modes.data(), 0) != ERROR_SUCCESS)
-        return;
+std::span<Target> Topology::GetTargets(Backend& backend, uint64_t current_generation)
+{
+    if (!valid || generation != current_generation) {
+        // Don't keep a failed query, so the next call tries again
+        valid = Query(backend);
+        generation = current_generation;
+    }
+    /* Only here, not on every access: everything using one GetTargets() result
+     * must see the same descriptions */
+    for (auto& target : targets) {
+        if (target.description_failed) {
+            target.description.reset();
+            target.description_failed = false;
+        }
+    }
+    return targets;
+}
 
-    for (const auto& path : paths) {
-        const auto& mode = modes.at(path.targetInfo.modeInfoIdx);
+template<typename F> static void ForEachDisplay(Backend& backend, F func)
+{
+    for (auto& target : topology.GetTargets(backend, topology_generation.load())) {
+        func(target);
+    }
+}
+
+static const wchar_t* GetFallbackDisplayName(Backend& backend, const TargetId& target)
+{
+    bool internal = false;
+    if (backend.GetTargetBaseType(target, internal) && internal)
+        return L"Internal Display";
+
+    return L"Unnamed";
+}
+
+static std::optional<TargetDescription> QueryTargetDescription(Backend& backend, const TargetId& target)
+{
+    display_config::TargetName target_name;
+    if (!backend.GetTargetName(target, target_name))
+        return std::nullopt;
+
+    TargetDescription description;
+    if (target_name.friendly_name_from_edid)
+        description.name = target_name.friendly_name;
+    else
+        description.name = GetFallbackDisplayName(backend, target); // Seen with eg a laptop display.
+    if (target_name.edid_ids_valid)
+        description.edid = target_name.edid_ids;
+    description.connector.adapter = target.adapter;
+    description.connector.output_technology = target_name.output_technology;
+    description.connector.instance = target_name.connector_instance;
+    return description;
+}
+
+// Get cached target description. The name is empty if the description could not be queried
+static const TargetDescription& GetTargetDescription(Backend& backend, Target& target)
+{
+    // Display names don't change while the topology stays the same
+    if (!target.description) {
+        auto description = QueryTargetDescription(backend, target.id);
+        target.description_failed = !description;
+        target.description = std::move(description).value_or(TargetDescription());
+    }
+    return *target.description;
+}
 
-        func(mode);
+/**
+ * Call a function for each of the given targets selected by a filter.
+ * Only targets with a known name are passed to the filter, as these are the ones
+ * GetDisplays() reports. Without a filter, all targets are visited.
+ */
+template<typename F>
+static void ForEachDisplay(Backend& backend, std::span<Target> targets, const DisplayFilter& filter, F func)
+{
+    size_t index = 0;
+    for (auto& target : targets) {
+        if (!filter) {
+            func(target);
+            continue;
+        }
+        const auto& name = GetTargetDescription(backend, target).name;
+        if (name.empty())
+            continue;
+        if (filter(DisplayRef { index++, name, target.id }))
+            func(target);
     }
 }
 
-static Status GetDisplayHDRStatus(const DISPLAYCONFIG_MODE_INFO& mode)
+/// Call a function for each display selected by a filter
+template<typename F> static void ForEachDisplay(Backend& backend, const DisplayFilter& filter, F func)
 {
+    ForEachDisplay(backend, topology.GetTargets(backend, topology_generation.load()), filter, func);
+}
+
+// Remember which API generation worked for a target, unless already known
+static void MemoizeApi(ApiGeneration& memo, ApiGeneration api)
+{
+    if (memo == ApiGeneration::Unknown)
+        memo = api;
+}
+
+static Status QueryDisplayHDRStatus(Backend& backend, Target& target)
+{
+    display_config::ColorInfo color_info;
+    auto result = display_config::CallResult::NotSupported;
     // Prefer GET_ADVANCED_COLOR_INFO_2, this reports the actual HDR mode if ACM is enabled
-    DISPLAYCONFIG_GET_ADVANCED_COLOR_INFO_2 getColorInfo2 = {};
-    getColorInfo2.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_ADVANCED_COLOR_INFO_2;
-    getColorInfo2.header.size = sizeof(getColorInfo2);
-    getColorInfo2.header.adapterId.HighPart = mode.adapterId.HighPart;
-    getColorInfo2.header.adapterId.LowPart = mode.adapterId.LowPart;
-    getColorInfo2.header.id = mode.id;
-    if (use_win11_24h2_color_functions && DisplayConfigGetDeviceInfo(&getColorInfo2.header) == ERROR_SUCCESS)
-    {
-        if (!getColorInfo2.highDynamicRangeSupported)
+    if (target.query_api != ApiGeneration::Legacy && backend.HasHdrStateFunctions()) {
+        result = backend.GetAdvancedColorInfo2(target.id, color_info);
+        if (result == display_config::CallResult::Success)
+            MemoizeApi(target.query_api, ApiGeneration::Win11_24H2);
+    }
+    if (result != display_config::CallResult::Success) {
+        if (!backend.GetAdvancedColorInfo(target.id, color_info))
             return Status::Unsupported;
-
-        // Only DISPLAYCONFIG_ADVANCED_COLOR_MODE_HDR is true HDR.
-        return getColorInfo2.activeColorMode == DISPLAYCONFIG_ADVANCED_COLOR_MODE_HDR ? Status::On : Status::Off;
+        // After a transient failure, the newer function is tried again next time
+        if (result == display_config::CallResult::NotSupported)
+            MemoizeApi(target.query_api, ApiGeneration::Legacy);
     }
 
-    DISPLAYCONFIG_GET_ADVANCED_COLOR_INFO getColorInfo = {};
-    getColorInfo.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_ADVANCED_COLOR_INFO;
-    getColorInfo.header.size = sizeof(getColorInfo);
-    getColorInfo.header.adapterId.HighPart = mode.adapterId.HighPart;
-    getColorInfo.header.adapterId.LowPart = mode.adapterId.LowPart;
-    getColorInfo.header.id = mode.id;
-
-    if (DisplayConfigGetDeviceInfo(&getColorInfo.header) != ERROR_SUCCESS)
+    if (!color_info.hdr_supported)
         return Status::Unsupported;
 
-    if (!getColorInfo.advancedColorSupported)
-        return Status::Unsupported;
+    return color_info.hdr_enabled ? Status::On : Status::Off;
+}
 
-    return getColorInfo.advancedColorEnabled ? Status::On : Status::Off;
+static Status GetDisplayHDRStatus(Backend& backend, Target& target)
+{
+    auto current_generation = status_generation.load();
+    if (!target.status || target.status_generation != current_generation) {
+        target.status = QueryDisplayHDRStatus(backend, target);
+        target.status_generation = current_generation;
+    }
+    return *target.status;
 }
 
-Status GetWindowsHDRStatus()
+static Status GetWindowsHDRStatusLocked(Backend& backend, const DisplayFilter& filter = {})
 {
     bool anySupported = false;
     bool anyEnabled = false;
 
-    ForEachDisplay([&](const DISPLAYCONFIG_MODE_INFO& mode) {
-        Status displayStatus = GetDisplayHDRStatus(mode);
+    ForEachDisplay(backend, filter, [&](Target& target) {
+        Status displayStatus = GetDisplayHDRStatus(backend, target);
         anySupported |= displayStatus != Status::Unsupported;
         anyEnabled |= displayStatus == Status::On;
     });
@@ -96,109 +305,317 @@ Status GetWindowsHDRStatus()
         return Status::Unsupported;
 }
 
-static std::optional<Status> SetDisplayHDRStatus(const DISPLAYCONFIG_MODE_INFO& mode, bool enable)
+Status GetWindowsHDRStatus()
 {
-    if (GetDisplayHDRStatus(mode) == Status::Unsupported)
+    std::lock_guard lock(topology_mutex);
+    return GetWindowsHDRStatusLocked(display_config::GetBackend());
+}
+
+Status GetWindowsHDRStatus(const DisplayFilter& filter)
+{
+    std::lock_guard lock(topology_mutex);
+    return GetWindowsHDRStatusLocked(display_config::GetBackend(), filter);
+}
+
+static std::optional<Status> SetDisplayHDRStatus(Backend& backend, Target& target, bool enable)
+{
+    if (GetDisplayHDRStatus(backend, target) == Status::Unsupported)
         return std::nullopt;
 
     /* Try SET_HDR_STATE first, if available (on Windows 11 >= 24H2).
      * This seems to work better with ACM enabled (in which case "advanced color" is always
      * enabled and changing it doesn't do much.) */
-    DISPLAYCONFIG_SET_HDR_STATE setHdrState = {};
-    setHdrState.header.type = DISPLAYCONFIG_DEVICE_INFO_SET_HDR_STATE;
-    setHdrState.header.size = sizeof(setHdrState);
-    setHdrState.header.adapterId.HighPart = mode.adapterId.HighPart;
-    setHdrState.header.adapterId.LowPart = mode.adapterId.LowPart;
-    setHdrState.header.id = mode.id;
-    setHdrState.enableHdr = enable;
-    if (use_win11_24h2_color_functions && DisplayConfigSetDeviceInfo(&setHdrState.header) == ERROR_SUCCESS)
-        return GetDisplayHDRStatus(mode);
-
-    DISPLAYCONFIG_SET_ADVANCED_COLOR_STATE setColorState = {};
-    setColorState.header.type = DISPLAYCONFIG_DEVICE_INFO_SET_ADVANCED_COLOR_STATE;
-    setColorState.header.size = sizeof(setColorState);
-    setColorState.header.adapterId.HighPart = mode.adapterId.HighPart;
-    setColorState.header.adapterId.LowPart = mode.adapterId.LowPart;
-    setColorState.header.id = mode.id;
-    setColorState.enableAdvancedColor = enable;
-
-    if (DisplayConfigSetDeviceInfo(&setColorState.header) != ERROR_SUCCESS)
-        return std::nullopt;
+    auto result = display_config::CallResult::NotSupported;
+    if (target.set_api != ApiGeneration::Legacy && backend.HasHdrStateFunctions()) {
+        result = backend.SetHdrState(target.id, enable);
+        if (result == display_config::CallResult::Success)
+            MemoizeApi(target.set_api, ApiGeneration::Win11_24H2);
+    }
+    if (result != display_config::CallResult::Success) {
+        if (!backend.SetAdvancedColorState(target.id, enable))
+            return std::nullopt;
+        if (result == display_config::CallResult::NotSupported)
+            MemoizeApi(target.set_api, ApiGeneration::Legacy);
+    }
+
     // Don't assume changing the HDR mode was successful... re-query the status
-    return GetDisplayHDRStatus(mode);
+    target.status_generation = status_generation.load();
+    target.status = QueryDisplayHDRStatus(backend, target);
+    return target.status;
 }
 
-std::optional<Status> SetWindowsHDRStatus(bool enable)
+// Merge display status into overall status: "on" takes precedence over "off"
+static void MergeStatus(std::optional<Status>& status, Status new_status)
 {
-    std::optional<Status> status;
+    if(!status)
+        status = new_status;
+    else
+        status = static_cast<Status>(std::max(static_cast<int>(*status), static_cast<int>(new_status)));
+}
 
-    ForEachDisplay([&](const DISPLAYCONFIG_MODE_INFO& mode) {
-        auto new_status = SetDisplayHDRStatus(mode, enable);
-        if (!new_status)
-            return;
+namespace {
+/// Request to switch a single target
+struct SetRequest
+{
+    Target* target;
+    bool enable;
+};
+} // anonymous namespace
+
+/**
+ * Set HDR status of targets concurrently.
+ * Targets are grouped by adapter; each group is handled by a single worker, so any
+ * adapter only sees one request at a time.
+ * Returns the new status of each target.
+ */
+static std::vector<std::optional<Status>> SetTargetsHDRStatusParallel(Backend& backend,
+                                                                      std::span<const SetRequest> requests)
+{
+    std::vector<AdapterId> adapters;
+    std::vector<std::vector<size_t>> adapter_requests;
+    for (size_t i = 0; i < requests.size(); i++) {
+        const auto& adapter = requests[i].target->id.adapter;
+        auto adapter_it = std::find(adapters.begin(), adapters.end(), adapter);
+        size_t adapter_idx = adapter_it - adapters.begin();
+        if (adapter_it == adapters.end()) {
+            adapters.push_back(adapter);
+            adapter_requests.emplace_back();
+        }
+        adapter_requests[adapter_idx].push_back(i);
+    }
 
-        if(!status)
-            status = *new_status;
-        else
-            status = static_cast<Status>(std::max(static_cast<int>(*status), static_cast<int>(*new_status)));
-    });
+    std::vector<std::optional<Status>> results(requests.size());
+    std::atomic<size_t> next_adapter = 0;
+    auto worker = [&]() {
+        size_t adapter_idx;
+        while ((adapter_idx = next_adapter++) < adapter_requests.size()) {
+            for (auto request_idx : adapter_requests[adapter_idx]) {
+                const auto& request = requests[request_idx];
+                results[request_idx] = SetDisplayHDRStatus(backend, *request.target, request.enable);
+            }
+        }
+    };
+
+    // Calling thread acts as one of the workers
+    size_t num_workers = std::min(adapter_requests.size(), max_switch_workers);
+    std::vector<std::thread> worker_threads;
+    for (size_t i = 1; i < num_workers; i++)
+        worker_threads.emplace_back(worker);
+    worker();
+    for (auto& thread : worker_threads)
+        thread.join();
+
+    return results;
+}
 
+/// Set HDR status of targets, concurrently if requested. Returns the new status of each target.
+static std::vector<std::optional<Status>> SetTargetsHDRStatus(Backend& backend, std::span<const SetRequest> requests,
+                                                              SwitchMode mode)
+{
+    if (mode == SwitchMode::Parallel)
+        return SetTargetsHDRStatusParallel(backend, requests);
+
+    std::vector<std::optional<Status>> results;
+    results.reserve(requests.size());
+    for (const auto& request : requests)
+        results.push_back(SetDisplayHDRStatus(backend, *request.target, request.enable));
+    return results;
+}
+
+static std::optional<Status> SetWindowsHDRStatusLocked(Backend& backend, bool enable, SwitchMode mode)
+{
+    std::vector<SetRequest> requests;
+    ForEachDisplay(backend, [&](Target& target) { requests.push_back(SetRequest { &target, enable }); });
+
+    std::optional<Status> status;
+    for (const auto& new_status : SetTargetsHDRStatus(backend, requests, mode)) {
+        if (new_status)
+            MergeStatus(status, *new_status);
+    }
     return status;
 }
 
-std::optional<Status> ToggleHDRStatus()
+std::optional<Status> SetWindowsHDRStatus(bool enable, SwitchMode mode)
+{
+    std::lock_guard lock(topology_mutex);
+    return SetWindowsHDRStatusLocked(display_config::GetBackend(), enable, mode);
+}
+
+std::optional<Status> ToggleHDRStatus(SwitchMode mode)
 {
-    auto status = GetWindowsHDRStatus();
+    std::lock_guard lock(topology_mutex);
+    auto& backend = display_config::GetBackend();
+    auto status = GetWindowsHDRStatusLocked(backend);
     if (status == Status::Unsupported)
         return Status::Unsupported;
-    return SetWindowsHDRStatus(status == Status::Off ? true : false);
+    return SetWindowsHDRStatusLocked(backend, status == Status::Off ? true : false, mode);
 }
 
-static const wchar_t* GetFallbackDisplayName(const DISPLAYCONFIG_MODE_INFO& mode)
+static Display MakeDisplay(Backend& backend, Target& target)
 {
-    DISPLAYCONFIG_TARGET_BASE_TYPE target_base = {};
-    target_base.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_BASE_TYPE;
-    target_base.header.size = sizeof(target_base);
-    target_base.header.adapterId.HighPart = mode.adapterId.HighPart;
-    target_base.header.adapterId.LowPart = mode.adapterId.LowPart;
-    target_base.header.id = mode.id;
+    Display disp;
+    disp.status = GetDisplayHDRStatus(backend, target);
+    const auto& description = GetTargetDescription(backend, target);
+    disp.name = description.name;
+    disp.id = target.id;
+    disp.edid = description.edid;
+    disp.connector = description.connector;
+    disp.api = target.query_api;
+    disp.clone_group = target.clone_group;
+    return disp;
+}
 
-    if (ERROR_SUCCESS == DisplayConfigGetDeviceInfo(&target_base.header)) {
-        if ((target_base.baseOutputTechnology != DISPLAYCONFIG_OUTPUT_TECHNOLOGY_OTHER)
-            && (target_base.baseOutputTechnology & DISPLAYCONFIG_OUTPUT_TECHNOLOGY_INTERNAL))
-            return L"Internal Display";
-    }
+void GetDisplays(DisplayList& list, const DisplayFilter& filter)
+{
+    std::lock_guard lock(topology_mutex);
+    auto& backend = display_config::GetBackend();
+
+    /* Make room for all displays up front, so filling the list needs at most one allocation.
+     * Both passes must see the same snapshot, as the room made depends on it */
+    auto targets = topology.GetTargets(backend, topology_generation.load());
+    size_t num_name_chars = 0;
+    for (auto& target : targets)
+        num_name_chars += GetTargetDescription(backend, target).name.size();
+    list.Reset(targets.size(), num_name_chars);
+
+    ForEachDisplay(backend, targets, filter, [&](Target& target) {
+        const auto& description = GetTargetDescription(backend, target);
+        if (description.name.empty())
+            return;
 
-    return L"Unnamed";
+        DisplayEntry entry;
+        entry.status = GetDisplayHDRStatus(backend, target);
+        entry.id = target.id;
+        entry.edid = description.edid;
+        entry.connector = description.connector;
+        entry.api = target.query_api;
+        entry.clone_group = target.clone_group;
+        list.Add(entry, description.name);
+    });
 }
 
-std::vector<Display> GetDisplays()
+std::vector<Display> GetDisplays(const DisplayFilter& filter)
 {
+    DisplayList list;
+    GetDisplays(list, filter);
+
     std::vector<Display> result;
+    result.reserve(list.GetDisplays().size());
+    for (const auto& entry : list.GetDisplays()) {
+        result.push_back({ std::wstring(entry.name), entry.status, entry.id, entry.edid, entry.connector, entry.api,
+                           entry.clone_group });
+    }
+    return result;
+}
 
-    ForEachDisplay([&](const DISPLAYCONFIG_MODE_INFO& mode) {
-        Display new_disp;
+std::vector<DisplayIdentity> GetDisplayIdentities()
+{
+    std::lock_guard lock(topology_mutex);
+    auto& backend = display_config::GetBackend();
 
-        new_disp.status = GetDisplayHDRStatus(mode);
+    std::vector<DisplayIdentity> result;
 
-        DISPLAYCONFIG_TARGET_DEVICE_NAME deviceName = {};
-        deviceName.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_NAME;
-        deviceName.header.size = sizeof(deviceName);
-        deviceName.header.adapterId.HighPart = mode.adapterId.HighPart;
-        deviceName.header.adapterId.LowPart = mode.adapterId.LowPart;
-        deviceName.header.id = mode.id;
-        if (DisplayConfigGetDeviceInfo(&deviceName.header) != ERROR_SUCCESS)
+    ForEachDisplay(backend, [&](Target& target) {
+        const auto& description = GetTargetDescription(backend, target);
+        if (description.name.empty())
             return;
 
-        if (deviceName.flags.friendlyNameFromEdid)
-            new_disp.name = deviceName.monitorFriendlyDeviceName;
-        else
-            new_disp.name = GetFallbackDisplayName(mode); // Seen with eg a laptop display.
+        result.emplace_back(target.id, description.name, description.edid, description.connector);
+    });
+
+    return result;
+}
 
-        result.emplace_back(std::move(new_disp));
+ReconcileResult ReconcileHDRStatus(const DesiredHDRState& desired, bool dry_run, const DisplayFilter& filter,
+                                   SwitchMode mode)
+{
+    std::lock_guard lock(topology_mutex);
+    auto& backend = display_config::GetBackend();
+
+    ReconcileResult result;
+    std::vector<SetRequest> requests;
+    std::vector<size_t> request_steps;
+
+    ForEachDisplay(backend, filter, [&](Target& target) {
+        ReconcileStep step;
+        step.display = MakeDisplay(backend, target);
+
+        auto desired_state = desired(step.display);
+        if (step.display.status == Status::Unsupported) {
+            step.action = ReconcileStep::Action::Unsupported;
+        } else if (!desired_state || *desired_state == (step.display.status == Status::On)) {
+            step.action = ReconcileStep::Action::Skip;
+            result.num_skipped++;
+            MergeStatus(result.status, step.display.status);
+        } else {
+            step.action = ReconcileStep::Action::Switch;
+            step.enable = *desired_state;
+            result.num_switched++;
+            requests.push_back(SetRequest { &target, step.enable });
+            request_steps.push_back(result.steps.size());
+        }
+        result.steps.emplace_back(std::move(step));
     });
 
+    if (dry_run) {
+        for (const auto& request : requests)
+            MergeStatus(result.status, request.enable ? Status::On : Status::Off);
+        return result;
+    }
+
+    auto new_status = SetTargetsHDRStatus(backend, requests, mode);
+    for (size_t i = 0; i < requests.size(); i++) {
+        auto& step = result.steps[request_steps[i]];
+        step.new_status = new_status[i];
+        if (new_status[i]) {
+            MergeStatus(result.status, *new_status[i]);
+        } else {
+            result.num_switched--;
+            result.num_failed++;
+        }
+    }
+
     return result;
 }
 
+ReconcileResult ReconcileHDRStatus(bool enable, bool dry_run, const DisplayFilter& filter, SwitchMode mode)
+{
+    return ReconcileHDRStatus([enable](const Display&) { return enable; }, dry_run, filter, mode);
+}
+
+uint64_t GetTopologyGeneration()
+{
+    return topology_generation.load();
+}
+
+void InvalidateTopology()
+{
+    ++topology_generation;
+}
+
+void InvalidateStatus()
+{
+    ++status_generation;
+}
+
+namespace display_config {
+Backend& GetBackend()
+{
+#if defined(_WIN32)
+    if (!current_backend)
+        return GetWin32Backend();
+#endif
+    // Elsewhere, there's no default backend
+    assert(current_backend && "No display configuration backend set, call SetBackend() first");
+    return *current_backend;
+}
+
+void SetBackend(Backend* backend)
+{
+    std::lock_guard lock(topology_mutex);
+    current_backend = backend;
+    InvalidateTopology();
+}
+} // namespace display_config
+
 } // namespace hdr
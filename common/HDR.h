@@ -10,8 +10,12 @@
 #ifndef HDR_H_
 #define HDR_H_
 
+#include <compare>
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -19,6 +23,66 @@ namespace hdr {
 
 enum class Status { Unsupported = 0, Off = 1, On = 2 };
 
+/// Adapter LUID
+struct AdapterId
+{
+    uint32_t low = 0;
+    int32_t high = 0;
+
+    auto operator<=>(const AdapterId&) const = default;
+};
+
+/// Identifies a display target
+struct TargetId
+{
+    AdapterId adapter;
+    uint32_t id = 0;
+
+    auto operator<=>(const TargetId&) const = default;
+};
+
+/// Identifies a display source, ie the image shown on one or more targets
+struct SourceId
+{
+    AdapterId adapter;
+    uint32_t id = 0;
+
+    auto operator<=>(const SourceId&) const = default;
+};
+
+/// Generation of display configuration API functions
+enum class ApiGeneration
+{
+    /// Not yet known
+    Unknown,
+    /// GET_ADVANCED_COLOR_INFO, SET_ADVANCED_COLOR_STATE
+    Legacy,
+    /// GET_ADVANCED_COLOR_INFO_2, SET_HDR_STATE (Windows 11 24H2 and up)
+    Win11_24H2
+};
+
+/// EDID manufacturer and product codes
+struct EdidId
+{
+    uint16_t manufacturer = 0;
+    uint16_t product = 0;
+
+    auto operator<=>(const EdidId&) const = default;
+};
+
+/// Connector a display is attached to
+struct Connector
+{
+    /// Adapter the connector belongs to
+    AdapterId adapter;
+    /// Kind of connector, a DISPLAYCONFIG_VIDEO_OUTPUT_TECHNOLOGY value
+    uint32_t output_technology = 0;
+    /// Instance of that kind of connector on the adapter
+    uint32_t instance = 0;
+
+    auto operator<=>(const Connector&) const = default;
+};
+
 /// Display information
 struct Display
 {
@@ -26,13 +90,150 @@ struct Display
     std::wstring name;
     /// HDR status
     Status status;
+    /// Display target
+    TargetId id;
+    /// EDID codes, if the display reported them
+    std::optional<EdidId> edid;
+    /// Connector the display is attached to
+    Connector connector;
+    /// API generation used to query the HDR status
+    ApiGeneration api = ApiGeneration::Unknown;
+    /**
+     * Clone group of the display. Set if the display shows the same source as other
+     * displays (clone or "duplicate" mode); these have the same clone group number.
+     */
+    std::optional<size_t> clone_group;
 };
 
+/// Identifying information of a display; unlike Display, doesn't include any state
+struct DisplayIdentity
+{
+    /// Display target
+    TargetId id;
+    /// Display name
+    std::wstring name;
+    /// EDID codes, if the display reported them
+    std::optional<EdidId> edid;
+    /// Connector the display is attached to
+    Connector connector;
+
+    bool operator==(const DisplayIdentity&) const = default;
+};
+
+/// Reference to a display, passed to display filters
+struct DisplayRef
+{
+    /// Index of the display in the result of an unfiltered GetDisplays()
+    size_t index;
+    /// Display name
+    std::wstring_view name;
+    /// Display target
+    TargetId id;
+};
+
+/**
+ * Filter selecting displays to operate on.
+ * Called before the status of a display is queried; displays that are not selected are not
+ * queried or switched at all.
+ */
+using DisplayFilter = std::function<bool(const DisplayRef&)>;
+
 Status GetWindowsHDRStatus();
-std::optional<Status> SetWindowsHDRStatus(bool enable);
-std::optional<Status> ToggleHDRStatus();
-/// Get information for all displays
-std::vector<Display> GetDisplays();
+/// Get HDR status over the displays selected by a filter
+Status GetWindowsHDRStatus(const DisplayFilter& filter);
+/**
+ * How displays are switched.
+ * With \c Parallel, displays on different adapters are switched concurrently. Displays on the same
+ * adapter are always switched one after another.
+ */
+enum class SwitchMode
+{
+    Sequential,
+    Parallel
+};
+
+std::optional<Status> SetWindowsHDRStatus(bool enable, SwitchMode mode = SwitchMode::Sequential);
+std::optional<Status> ToggleHDRStatus(SwitchMode mode = SwitchMode::Sequential);
+/// Get information for all displays, or the ones selected by a filter
+std::vector<Display> GetDisplays(const DisplayFilter& filter = {});
+/// Get identifying information for all displays. Doesn't query the HDR status
+std::vector<DisplayIdentity> GetDisplayIdentities();
+
+/// Step of reconciling a display's HDR status with the desired state
+struct ReconcileStep
+{
+    enum class Action
+    {
+        /// Display is already in the desired state, or no state was desired
+        Skip,
+        /// Display needs switching
+        Switch,
+        /// Display doesn't support HDR
+        Unsupported
+    };
+
+    /// Display, with status before switching
+    Display display;
+    Action action = Action::Skip;
+    /// Desired HDR state, if action is Switch
+    bool enable = false;
+    /// Status after switching. Only set if the switch was applied successfully.
+    std::optional<Status> new_status;
+};
+
+/// Result of ReconcileHDRStatus()
+struct ReconcileResult
+{
+    /// One step per display
+    std::vector<ReconcileStep> steps;
+    /// Number of displays switched (or to be switched, on a dry run)
+    size_t num_switched = 0;
+    /// Number of supported displays that were already in the desired state
+    size_t num_skipped = 0;
+    /// Number of displays for which switching failed
+    size_t num_failed = 0;
+    /**
+     * Overall status after reconciling, merged the same way SetWindowsHDRStatus() does.
+     * On a dry run, the predicted status. Not set if no display supports HDR.
+     */
+    std::optional<Status> status;
+};
+
+/// Returns the desired HDR state for a display, or \c std::nullopt to leave it unchanged
+using DesiredHDRState = std::function<std::optional<bool>(const Display&)>;
+
+/**
+ * Bring displays into a desired HDR state.
+ * Compares the current status of each display against the desired state and only switches
+ * displays that differ.
+ * \param desired Desired state for each display.
+ * \param dry_run If \c true, only plan the steps, but don't switch anything.
+ * \param filter Displays to consider. If not given, all displays are considered.
+ * \param mode How to switch the displays.
+ */
+ReconcileResult ReconcileHDRStatus(const DesiredHDRState& desired, bool dry_run = false,
+                                   const DisplayFilter& filter = {}, SwitchMode mode = SwitchMode::Sequential);
+/// Bring all displays, or the ones selected by a filter, into the same HDR state
+ReconcileResult ReconcileHDRStatus(bool enable, bool dry_run = false, const DisplayFilter& filter = {},
+                                   SwitchMode mode = SwitchMode::Sequential);
+
+/**
+ * Get the current display topology generation.
+ * Display configuration and status are cached, and only re-queried if the generation changes.
+ */
+uint64_t GetTopologyGeneration();
+/**
+ * Increment the display topology generation, causing display configuration and status to be
+ * re-queried on the next call. Should be called when the display configuration changed, ie
+ * upon receiving WM_DISPLAYCHANGE.
+ */
+void InvalidateTopology();
+/**
+ * Cause the HDR status of displays to be re-queried on the next call, while keeping the rest of
+ * the cached display configuration. Useful for long-running processes that don't receive
+ * display change notifications for every HDR mode change.
+ */
+void InvalidateStatus();
 
 } // namespace hdr
 
@@ -0,0 +1,84 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Ipc.h"
+
+#include <algorithm>
+
+namespace hdr::ipc {
+
+static constexpr size_t receive_chunk_size = 4096;
+
+// Receive more data into the buffer
+bool Connection::Fill()
+{
+    // Drop consumed data before growing the buffer
+    if (buffer_pos > 0) {
+        buffer.erase(0, buffer_pos);
+        buffer_pos = 0;
+    }
+
+    auto old_size = buffer.size();
+    buffer.resize(old_size + receive_chunk_size);
+    auto received = DoReceive(buffer.data() + old_size, receive_chunk_size);
+    buffer.resize(old_size + std::max<ptrdiff_t>(received, 0));
+    return received > 0;
+}
+
+bool Connection::ReadLine(std::string& line)
+{
+    // Number of unconsumed bytes already searched for a newline
+    size_t searched = 0;
+    while (true) {
+        auto newline = buffer.find('\n', buffer_pos + searched);
+        if (newline != std::string::npos) {
+            line.assign(buffer, buffer_pos, newline - buffer_pos);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            buffer_pos = newline + 1;
+            return true;
+        }
+        searched = buffer.size() - buffer_pos;
+        if (!Fill())
+            return false;
+    }
+}
+
+bool Connection::Read(size_t size, std::string& data)
+{
+    while (buffer.size() - buffer_pos < size) {
+        if (!Fill())
+            return false;
+    }
+    data.assign(buffer, buffer_pos, size);
+    buffer_pos += size;
+    return true;
+}
+
+bool Connection::Write(std::string_view data)
+{
+    while (!data.empty()) {
+        auto sent = DoSend(data.data(), data.size());
+        if (sent <= 0)
+            return false;
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+} // namespace hdr::ipc
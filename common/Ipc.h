@@ -0,0 +1,88 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_IPC_H_
+#define COMMON_IPC_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace hdr {
+/**
+ * Local inter-process communication.
+ * Endpoints are named pipes on Windows and Unix domain sockets elsewhere. Only processes of the
+ * same user on the same machine are expected to connect.
+ */
+namespace ipc {
+/// Byte stream connection between two processes
+class Connection
+{
+public:
+    virtual ~Connection() = default;
+
+    /// Read a line, without the terminating newline. Returns \c false on error or end of stream
+    bool ReadLine(std::string& line);
+    /// Read exactly \a size bytes. Returns \c false on error or end of stream
+    bool Read(size_t size, std::string& data);
+    /// Write all of \a data
+    bool Write(std::string_view data);
+    /**
+     * Shut the connection down: reads and writes in progress, and any later ones, fail.
+     * Unlike the other methods, may be called from another thread while the connection is in use.
+     */
+    virtual void Shutdown() = 0;
+
+protected:
+    /// Receive available data. Returns the number of bytes received, 0 at end of stream, or -1 on error
+    virtual ptrdiff_t DoReceive(char* data, size_t size) = 0;
+    /// Send data. May send less than requested; returns the number of bytes sent, or -1 on error
+    virtual ptrdiff_t DoSend(const char* data, size_t size) = 0;
+
+private:
+    /// Received, but not yet consumed data
+    std::string buffer;
+    /// Start of unconsumed data in buffer
+    size_t buffer_pos = 0;
+
+    bool Fill();
+};
+
+/// Accepts connections on an endpoint
+class Listener
+{
+public:
+    virtual ~Listener() = default;
+
+    /// Wait for a client to connect. Returns \c nullptr on error
+    virtual std::unique_ptr<Connection> Accept() = 0;
+};
+
+/**
+ * Start listening on an endpoint.
+ * Returns \c nullptr if the endpoint could not be created, in particular if another process is
+ * already listening on it.
+ */
+std::unique_ptr<Listener> Listen(std::string_view name);
+/// Connect to an endpoint. Returns \c nullptr if nobody is listening on it
+std::unique_ptr<Connection> Connect(std::string_view name);
+} // namespace ipc
+} // namespace hdr
+
+#endif // COMMON_IPC_H_
@@ -0,0 +1,186 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// IPC using Unix domain sockets
+
+#include "Ipc.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <format>
+#include <utility>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace hdr::ipc {
+
+namespace {
+/// Owns a socket file descriptor
+class Socket
+{
+    int fd = -1;
+
+public:
+    explicit Socket(int fd) : fd(fd) { }
+    ~Socket()
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    int Get() const { return fd; }
+    /// Give up ownership of the descriptor
+    int Release() { return std::exchange(fd, -1); }
+};
+
+class SocketConnection : public Connection
+{
+    Socket socket;
+
+public:
+    explicit SocketConnection(int fd) : socket(fd) { }
+
+    void Shutdown() override;
+
+protected:
+    ptrdiff_t DoReceive(char* data, size_t size) override;
+    ptrdiff_t DoSend(const char* data, size_t size) override;
+};
+
+class SocketListener : public Listener
+{
+    Socket socket;
+    std::string path;
+
+public:
+    SocketListener(int fd, std::string path) : socket(fd), path(std::move(path)) { }
+    ~SocketListener() override { unlink(path.c_str()); }
+
+    std::unique_ptr<Connection> Accept() override;
+};
+} // anonymous namespace
+
+ptrdiff_t SocketConnection::DoReceive(char* data, size_t size)
+{
+    ssize_t result;
+    do {
+        result = recv(socket.Get(), data, size, 0);
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+ptrdiff_t SocketConnection::DoSend(const char* data, size_t size)
+{
+    ssize_t result;
+    do {
+        result = send(socket.Get(), data, size, MSG_NOSIGNAL);
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+void SocketConnection::Shutdown()
+{
+    // Wakes up a blocked recv(), which then returns end of stream
+    shutdown(socket.Get(), SHUT_RDWR);
+}
+
+std::unique_ptr<Connection> SocketListener::Accept()
+{
+    int fd;
+    do {
+        fd = accept(socket.Get(), nullptr, nullptr);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0)
+        return nullptr;
+    return std::make_unique<SocketConnection>(fd);
+}
+
+// Socket path: in the per-user runtime directory, if available
+static std::string GetSocketPath(std::string_view name)
+{
+    if (const char* runtime_dir = getenv("XDG_RUNTIME_DIR"); runtime_dir && *runtime_dir)
+        return std::format("{}/{}.sock", runtime_dir, name);
+    return std::format("/tmp/{}-{}.sock", name, getuid());
+}
+
+static bool MakeAddress(const std::string& path, sockaddr_un& addr)
+{
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+    path.copy(addr.sun_path, path.size());
+    return true;
+}
+
+static int ConnectSocket(const std::string& path)
+{
+    sockaddr_un addr;
+    if (!MakeAddress(path, addr))
+        return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::unique_ptr<Listener> Listen(std::string_view name)
+{
+    auto path = GetSocketPath(name);
+    sockaddr_un addr;
+    if (!MakeAddress(path, addr))
+        return nullptr;
+
+    // A socket file may be left over from a process that exited without cleaning up
+    if (int other = ConnectSocket(path); other >= 0) {
+        close(other);
+        return nullptr;
+    }
+    unlink(path.c_str());
+
+    Socket listen_socket(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (listen_socket.Get() < 0)
+        return nullptr;
+    if (bind(listen_socket.Get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+        return nullptr;
+    if (listen(listen_socket.Get(), SOMAXCONN) != 0) {
+        unlink(path.c_str());
+        return nullptr;
+    }
+
+    return std::make_unique<SocketListener>(listen_socket.Release(), std::move(path));
+}
+
+std::unique_ptr<Connection> Connect(std::string_view name)
+{
+    int fd = ConnectSocket(GetSocketPath(name));
+    if (fd < 0)
+        return nullptr;
+    return std::make_unique<SocketConnection>(fd);
+}
+
+} // namespace hdr::ipc
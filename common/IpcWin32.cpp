@@ -0,0 +1,199 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// IPC using named pipes
+
+#include "Ipc.h"
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <utility>
+
+#include "framework.h"
+
+namespace hdr::ipc {
+
+namespace {
+/// Owns a pipe handle
+class PipeHandle
+{
+    HANDLE handle = INVALID_HANDLE_VALUE;
+
+public:
+    explicit PipeHandle(HANDLE handle) : handle(handle) { }
+    ~PipeHandle()
+    {
+        if (handle != INVALID_HANDLE_VALUE)
+            CloseHandle(handle);
+    }
+    PipeHandle(const PipeHandle&) = delete;
+    PipeHandle& operator=(const PipeHandle&) = delete;
+
+    HANDLE Get() const { return handle; }
+    /// Give up ownership of the handle
+    HANDLE Release() { return std::exchange(handle, INVALID_HANDLE_VALUE); }
+    /// Take ownership of another handle
+    void Reset(HANDLE new_handle)
+    {
+        if (handle != INVALID_HANDLE_VALUE)
+            CloseHandle(handle);
+        handle = new_handle;
+    }
+};
+
+class PipeConnection : public Connection
+{
+protected:
+    PipeHandle pipe;
+    /// Set by Shutdown(); fails reads and writes that weren't started yet
+    std::atomic<bool> shut_down = false;
+
+public:
+    explicit PipeConnection(HANDLE handle) : pipe(handle) { }
+
+    void Shutdown() override;
+
+protected:
+    ptrdiff_t DoReceive(char* data, size_t size) override;
+    ptrdiff_t DoSend(const char* data, size_t size) override;
+};
+
+/// Server end of a pipe; disconnects the client when done
+class ServerPipeConnection : public PipeConnection
+{
+public:
+    using PipeConnection::PipeConnection;
+    ~ServerPipeConnection() override
+    {
+        // Make sure the client has received everything before disconnecting
+        FlushFileBuffers(pipe.Get());
+        DisconnectNamedPipe(pipe.Get());
+    }
+
+    void Shutdown() override
+    {
+        // Disconnecting also fails reads that start between checking the flag and cancelling
+        DisconnectNamedPipe(pipe.Get());
+        PipeConnection::Shutdown();
+    }
+};
+
+class PipeListener : public Listener
+{
+    std::wstring pipe_name;
+    /// Pipe instance waiting for the next client
+    PipeHandle next_instance;
+
+public:
+    PipeListener(std::wstring pipe_name, HANDLE first_instance)
+        : pipe_name(std::move(pipe_name)), next_instance(first_instance)
+    {
+    }
+
+    std::unique_ptr<Connection> Accept() override;
+};
+} // anonymous namespace
+
+void PipeConnection::Shutdown()
+{
+    shut_down = true;
+    // Also cancels synchronous I/O issued by other threads
+    CancelIoEx(pipe.Get(), nullptr);
+}
+
+ptrdiff_t PipeConnection::DoReceive(char* data, size_t size)
+{
+    if (shut_down)
+        return -1;
+    DWORD num_read = 0;
+    if (!ReadFile(pipe.Get(), data, static_cast<DWORD>(std::min<size_t>(size, MAXDWORD)), &num_read, nullptr))
+        return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -1;
+    return num_read;
+}
+
+ptrdiff_t PipeConnection::DoSend(const char* data, size_t size)
+{
+    if (shut_down)
+        return -1;
+    DWORD num_written = 0;
+    if (!WriteFile(pipe.Get(), data, static_cast<DWORD>(std::min<size_t>(size, MAXDWORD)), &num_written, nullptr))
+        return -1;
+    return num_written;
+}
+
+static constexpr DWORD pipe_buffer_size = 4096;
+
+static HANDLE CreatePipeInstance(const std::wstring& pipe_name, bool first)
+{
+    DWORD open_mode = PIPE_ACCESS_DUPLEX | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+    return CreateNamedPipeW(pipe_name.c_str(), open_mode,
+                            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                            PIPE_UNLIMITED_INSTANCES, pipe_buffer_size, pipe_buffer_size, 0, nullptr);
+}
+
+std::unique_ptr<Connection> PipeListener::Accept()
+{
+    if (next_instance.Get() == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    if (!ConnectNamedPipe(next_instance.Get(), nullptr) && GetLastError() != ERROR_PIPE_CONNECTED)
+        return nullptr;
+
+    auto connection = std::make_unique<ServerPipeConnection>(next_instance.Release());
+    // Create the next instance right away, so clients arriving in the meantime can queue up
+    next_instance.Reset(CreatePipeInstance(pipe_name, false));
+    return connection;
+}
+
+// Pipe name: pipes are visible across sessions, so include the session ID
+static std::wstring GetPipeName(std::string_view name)
+{
+    DWORD session_id = 0;
+    ProcessIdToSessionId(GetCurrentProcessId(), &session_id);
+    return std::format(L"\\\\.\\pipe\\{}-{}", std::wstring(name.begin(), name.end()), session_id);
+}
+
+std::unique_ptr<Listener> Listen(std::string_view name)
+{
+    auto pipe_name = GetPipeName(name);
+    // Fails if another process already created the pipe
+    HANDLE first_instance = CreatePipeInstance(pipe_name, true);
+    if (first_instance == INVALID_HANDLE_VALUE)
+        return nullptr;
+    return std::make_unique<PipeListener>(std::move(pipe_name), first_instance);
+}
+
+/// Time to wait for a busy server to become available
+static constexpr DWORD connect_timeout_ms = 1000;
+
+std::unique_ptr<Connection> Connect(std::string_view name)
+{
+    auto pipe_name = GetPipeName(name);
+    while (true) {
+        HANDLE pipe =
+            CreateFileW(pipe_name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (pipe != INVALID_HANDLE_VALUE)
+            return std::make_unique<PipeConnection>(pipe);
+        // All instances busy: wait for one to become available, otherwise nobody is listening
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(pipe_name.c_str(), connect_timeout_ms))
+            return nullptr;
+    }
+}
+
+} // namespace hdr::ipc
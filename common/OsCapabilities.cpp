@@ -0,0 +1,82 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "OsCapabilities.h"
+
+#include <atomic>
+
+#if defined(_WIN32)
+#include "framework.h"
+#endif
+
+namespace hdr {
+
+OsCapabilities OsCapabilities::FromBuild(uint32_t windows_build)
+{
+    OsCapabilities caps;
+    caps.windows_build = windows_build;
+    caps.per_monitor_dpi_v2 = windows_build >= 16299;
+    caps.supported_os = windows_build >= 17134;
+    caps.dark_mode_menus = windows_build >= 18362;
+    caps.hdr_state_functions = windows_build >= 26100;
+    return caps;
+}
+
+#if defined(_WIN32)
+static uint32_t QueryWindowsBuild()
+{
+    // RtlGetVersion reports the actual version, regardless of the application manifest
+    using PFN_RtlGetVersion = LONG(WINAPI*)(OSVERSIONINFOW*);
+    auto RtlGetVersion = reinterpret_cast<PFN_RtlGetVersion>(
+        reinterpret_cast<void*>(GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "RtlGetVersion")));
+    if (!RtlGetVersion)
+        return 0;
+
+    OSVERSIONINFOW version_info = { sizeof(version_info) };
+    if (RtlGetVersion(&version_info) != 0 || version_info.dwMajorVersion < 10)
+        return 0;
+    return version_info.dwBuildNumber;
+}
+#endif
+
+static OsCapabilities ProbeOsCapabilities()
+{
+#if defined(_WIN32)
+    return OsCapabilities::FromBuild(QueryWindowsBuild());
+#else
+    return OsCapabilities();
+#endif
+}
+
+static std::atomic<const OsCapabilities*> capabilities_override;
+
+const OsCapabilities& GetOsCapabilities()
+{
+    if (const auto* override_caps = capabilities_override.load())
+        return *override_caps;
+
+    static const OsCapabilities probed = ProbeOsCapabilities();
+    return probed;
+}
+
+void SetOsCapabilitiesOverride(const OsCapabilities* capabilities)
+{
+    capabilities_override.store(capabilities);
+}
+
+} // namespace hdr
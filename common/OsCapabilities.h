@@ -0,0 +1,55 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_OSCAPABILITIES_H_
+#define COMMON_OSCAPABILITIES_H_
+
+#include <cstdint>
+
+namespace hdr {
+/// Operating system capabilities relevant to HDRTray and HDRCmd
+struct OsCapabilities
+{
+    /// Windows 10 build number. 0 if unknown, or not running on Windows
+    uint32_t windows_build = 0;
+    /// Per-monitor DPI awareness V2 is available (Windows 10 1709)
+    bool per_monitor_dpi_v2 = false;
+    /// Running on the minimum version HDRTray and HDRCmd work on (Windows 10 1803)
+    bool supported_os = false;
+    /// Dark mode for menus is available (Windows 10 1903)
+    bool dark_mode_menus = false;
+    /// GET_ADVANCED_COLOR_INFO_2 and SET_HDR_STATE are available (Windows 11 24H2)
+    bool hdr_state_functions = false;
+
+    /// Derive capabilities from a Windows 10 build number
+    static OsCapabilities FromBuild(uint32_t windows_build);
+};
+
+/**
+ * Get the capabilities of the running OS.
+ * The OS is probed on the first call, later calls return the cached result. Thread-safe.
+ */
+const OsCapabilities& GetOsCapabilities();
+/**
+ * Override the result of GetOsCapabilities(), eg for testing with a simulated backend.
+ * Pass \c nullptr to return to the actual capabilities. The override must stay valid while set.
+ */
+void SetOsCapabilitiesOverride(const OsCapabilities* capabilities);
+} // namespace hdr
+
+#endif // COMMON_OSCAPABILITIES_H_
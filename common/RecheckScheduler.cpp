@@ -0,0 +1,76 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "RecheckScheduler.h"
+
+#include <algorithm>
+
+namespace hdr {
+
+RecheckScheduler::RecheckScheduler(const Clock& clock) : RecheckScheduler(clock, Settings()) { }
+
+RecheckScheduler::RecheckScheduler(const Clock& clock, const Settings& settings) : clock(clock), settings(settings) { }
+
+void RecheckScheduler::NotifyChange()
+{
+    auto now = clock.Now();
+    stats.events++;
+    give_up_time = now + settings.give_up_after;
+    interval = settings.initial_interval;
+
+    if (!next_check) {
+        // Idle: check right away
+        next_check = now;
+    } else {
+        // Part of a burst: postpone the check a bit, but not indefinitely
+        stats.coalesced_events++;
+        if (!pending_since)
+            pending_since = now;
+        next_check = std::min(now + settings.coalesce_delay, *pending_since + settings.max_coalesce_delay);
+    }
+}
+
+bool RecheckScheduler::CheckDue() const
+{
+    return next_check && clock.Now() >= *next_check;
+}
+
+void RecheckScheduler::CheckDone(bool changed)
+{
+    auto now = clock.Now();
+    stats.checks++;
+    pending_since.reset();
+
+    if (changed || now >= give_up_time) {
+        // Settled (or no point in waiting any longer)
+        next_check.reset();
+        return;
+    }
+
+    next_check = std::min(now + interval, give_up_time);
+    interval = std::min(interval * 2, settings.max_interval);
+}
+
+std::optional<Clock::duration> RecheckScheduler::TimeUntilNextCheck() const
+{
+    if (!next_check)
+        return std::nullopt;
+    return std::max(*next_check - clock.Now(), Clock::duration::zero());
+}
+
+} // namespace hdr
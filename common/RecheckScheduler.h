@@ -0,0 +1,100 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_RECHECKSCHEDULER_H_
+#define COMMON_RECHECKSCHEDULER_H_
+
+#include "Clock.h"
+
+#include <cstdint>
+#include <optional>
+
+namespace hdr {
+/**
+ * Decides when to (re-)check the HDR status after display changes.
+ *
+ * HDR status isn't always up-to-date when a display change is signalled, so it needs to
+ * be re-checked for a while. The scheduler:
+ * - checks right away on the first change event,
+ * - coalesces further events arriving in quick succession into a single check,
+ * - re-checks with exponentially growing intervals while the status appears unchanged,
+ * - and goes idle once a change was detected or a time limit is reached.
+ *
+ * The scheduler doesn't do any waiting itself; the user is expected to arrange a wakeup
+ * after TimeUntilNextCheck() and then call CheckDue().
+ */
+class RecheckScheduler
+{
+public:
+    struct Settings
+    {
+        /// Delay for checking after a change event that arrived during a burst
+        Clock::duration coalesce_delay = std::chrono::milliseconds(50);
+        /// Maximum time a check is postponed by a continuous burst of change events
+        Clock::duration max_coalesce_delay = std::chrono::milliseconds(250);
+        /// Interval before the first re-check
+        Clock::duration initial_interval = std::chrono::milliseconds(100);
+        /// Maximum interval between re-checks
+        Clock::duration max_interval = std::chrono::milliseconds(1600);
+        /// Time after the last change event after which re-checking stops
+        Clock::duration give_up_after = std::chrono::seconds(5);
+    };
+
+    struct Stats
+    {
+        /// Change events received
+        uint64_t events = 0;
+        /// Change events that didn't cause an immediate check
+        uint64_t coalesced_events = 0;
+        /// Checks performed
+        uint64_t checks = 0;
+    };
+
+    explicit RecheckScheduler(const Clock& clock = SteadyClock::Get());
+    RecheckScheduler(const Clock& clock, const Settings& settings);
+
+    /// Notify about a display change event
+    void NotifyChange();
+    /// Whether a check should be performed now
+    bool CheckDue() const;
+    /// Report a check was performed, and whether it detected a change in status
+    void CheckDone(bool changed);
+    /// Time until the next check is due. Not set if no check is scheduled
+    std::optional<Clock::duration> TimeUntilNextCheck() const;
+    /// Whether any checks are scheduled
+    bool IsIdle() const { return !next_check.has_value(); }
+
+    const Stats& GetStats() const { return stats; }
+
+private:
+    const Clock& clock;
+    Settings settings;
+    Stats stats;
+
+    /// Time at which the next check is due
+    std::optional<Clock::time_point> next_check;
+    /// Time of the earliest change event not yet covered by a check
+    std::optional<Clock::time_point> pending_since;
+    /// Time at which re-checking stops
+    Clock::time_point give_up_time;
+    /// Current re-check interval
+    Clock::duration interval {};
+};
+} // namespace hdr
+
+#endif // COMMON_RECHECKSCHEDULER_H_
@@ -0,0 +1,92 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "StatusWatcher.h"
+
+#include <algorithm>
+
+namespace hdr {
+
+StatusWatcher::StatusWatcher(const Clock& clock, DisplayFilter filter, const RecheckScheduler::Settings& settings)
+    : clock(clock), filter(std::move(filter)), scheduler(clock, settings)
+{
+    displays = QueryDisplays();
+}
+
+std::map<TargetId, StatusWatcher::DisplayState> StatusWatcher::QueryDisplays() const
+{
+    std::map<TargetId, DisplayState> result;
+    for (auto& disp : GetDisplays(filter))
+        result.emplace(disp.id, DisplayState { std::move(disp.name), disp.status, false });
+    return result;
+}
+
+void StatusWatcher::NotifyChange()
+{
+    InvalidateTopology();
+    scheduler.NotifyChange();
+
+    // Displays not supporting HDR are not expected to change
+    seen_transition = false;
+    for (auto& [id, state] : displays)
+        state.pending = state.status != Status::Unsupported;
+}
+
+std::vector<StatusTransition> StatusWatcher::Poll()
+{
+    std::vector<StatusTransition> transitions;
+    if (!scheduler.CheckDue())
+        return transitions;
+
+    // Status may lag behind the change event, so re-query even if the topology is unchanged
+    InvalidateStatus();
+    auto new_displays = QueryDisplays();
+    auto now = clock.Now();
+
+    // Both maps are ordered by target, so walk them side by side
+    auto old_it = displays.begin();
+    auto new_it = new_displays.begin();
+    while (old_it != displays.end() || new_it != new_displays.end()) {
+        if (new_it == new_displays.end() || (old_it != displays.end() && old_it->first < new_it->first)) {
+            transitions.push_back({ now, old_it->first, old_it->second.name, old_it->second.status, std::nullopt });
+            ++old_it;
+        } else if (old_it == displays.end() || new_it->first < old_it->first) {
+            transitions.push_back({ now, new_it->first, new_it->second.name, std::nullopt, new_it->second.status });
+            ++new_it;
+        } else {
+            if (old_it->second.status != new_it->second.status) {
+                transitions.push_back(
+                    { now, new_it->first, new_it->second.name, old_it->second.status, new_it->second.status });
+            } else {
+                new_it->second.pending = old_it->second.pending;
+            }
+            ++old_it;
+            ++new_it;
+        }
+    }
+
+    displays = std::move(new_displays);
+    /* With multiple displays, status changes may be spread out over some time, so only stop
+     * re-checking early once no display is pending */
+    seen_transition |= !transitions.empty();
+    bool any_pending = std::ranges::any_of(displays, [](const auto& entry) { return entry.second.pending; });
+    scheduler.CheckDone(seen_transition && !any_pending);
+    return transitions;
+}
+
+} // namespace hdr
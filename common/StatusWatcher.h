@@ -0,0 +1,90 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_STATUSWATCHER_H_
+#define COMMON_STATUSWATCHER_H_
+
+#include "Clock.h"
+#include "HDR.h"
+#include "RecheckScheduler.h"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace hdr {
+/// Change in HDR status of a single display
+struct StatusTransition
+{
+    /// Time the transition was detected
+    Clock::time_point time;
+    TargetId id;
+    std::wstring name;
+    /// Previous status. Not set if the display was added
+    std::optional<Status> old_status;
+    /// New status. Not set if the display was removed
+    std::optional<Status> new_status;
+};
+
+/**
+ * Detects per-display HDR status changes after display change events.
+ *
+ * The user forwards change events (WM_DISPLAYCHANGE) via NotifyChange(), then calls Poll()
+ * when TimeUntilNextCheck() elapsed. Re-checking is driven by a RecheckScheduler: status is
+ * re-queried for a limited time, or until a change was seen and no display is pending anymore.
+ * A display is pending while it supports HDR and didn't change status since the last change event.
+ * Not thread-safe.
+ */
+class StatusWatcher
+{
+public:
+    /// Take a snapshot of the current status of the displays selected by \a filter
+    explicit StatusWatcher(const Clock& clock = SteadyClock::Get(), DisplayFilter filter = {},
+                           const RecheckScheduler::Settings& settings = {});
+
+    /// Notify about a display change event
+    void NotifyChange();
+    /// Re-check the status, if a check is due. Returns the detected transitions
+    std::vector<StatusTransition> Poll();
+    /// Time until Poll() should be called next. Not set if no check is scheduled
+    std::optional<Clock::duration> TimeUntilNextCheck() const { return scheduler.TimeUntilNextCheck(); }
+
+    const RecheckScheduler::Stats& GetStats() const { return scheduler.GetStats(); }
+
+private:
+    struct DisplayState
+    {
+        std::wstring name;
+        Status status;
+        /// Whether the display may still change status in response to the last change event
+        bool pending = false;
+    };
+
+    const Clock& clock;
+    DisplayFilter filter;
+    RecheckScheduler scheduler;
+    std::map<TargetId, DisplayState> displays;
+    /// Whether any transition was seen since the last change event
+    bool seen_transition = false;
+
+    std::map<TargetId, DisplayState> QueryDisplays() const;
+};
+} // namespace hdr
+
+#endif // COMMON_STATUSWATCHER_H_
@@ -0,0 +1,97 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "StringTable.h"
+
+#include <algorithm>
+
+namespace l10n {
+std::span<const char16_t> StringBlockData(const void* data, size_t num_bytes)
+{
+    return std::span(static_cast<const char16_t*>(data), num_bytes / sizeof(char16_t));
+}
+
+bool ParseStringBlock(std::span<const char16_t> block_data, std::span<std::u16string_view, stringsPerBlock> strings)
+{
+    std::fill(strings.begin(), strings.end(), std::u16string_view());
+    size_t pos = 0;
+    for (auto& str : strings) {
+        if (pos >= block_data.size())
+            return false;
+        size_t len = block_data[pos++];
+        if (len > block_data.size() - pos)
+            return false;
+        str = std::u16string_view(block_data.data() + pos, len);
+        pos += len;
+    }
+    return true;
+}
+
+bool StringTable::AddBlock(int block_id, std::span<const char16_t> block_data)
+{
+    if (block_id < 1)
+        return false;
+
+    std::u16string_view block_strings[stringsPerBlock];
+    bool result = ParseStringBlock(block_data, block_strings);
+
+    auto first_nonempty =
+        std::find_if(std::begin(block_strings), std::end(block_strings), [](auto str) { return !str.empty(); });
+    if (first_nonempty == std::end(block_strings))
+        return result;
+    auto last_nonempty = std::find_if(std::rbegin(block_strings), std::rend(block_strings),
+                                      [](auto str) { return !str.empty(); })
+                             .base();
+
+    int block_first_id = (block_id - 1) * stringsPerBlock;
+    int add_first = block_first_id + static_cast<int>(first_nonempty - std::begin(block_strings));
+    int add_end = block_first_id + static_cast<int>(last_nonempty - std::begin(block_strings));
+
+    // Grow table to cover the block's strings
+    if (strings.empty()) {
+        first_id = add_first;
+        strings.resize(add_end - add_first);
+    } else {
+        if (add_first < first_id) {
+            strings.insert(strings.begin(), first_id - add_first, std::u16string_view());
+            first_id = add_first;
+        }
+        if (add_end > first_id + static_cast<int>(strings.size()))
+            strings.resize(add_end - first_id);
+    }
+
+    for (int id = add_first; id < add_end; id++) {
+        auto& entry = strings[id - first_id];
+        if (entry.empty())
+            entry = block_strings[id - block_first_id];
+    }
+    return result;
+}
+
+std::u16string_view StringTable::Find(int resource_id) const
+{
+    if (resource_id < first_id || resource_id - first_id >= static_cast<int>(strings.size()))
+        return {};
+    return strings[resource_id - first_id];
+}
+
+size_t StringTable::CountStrings() const
+{
+    return std::count_if(strings.begin(), strings.end(), [](auto str) { return !str.empty(); });
+}
+} // namespace l10n
@@ -0,0 +1,79 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_STRINGTABLE_H_
+#define COMMON_STRINGTABLE_H_
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace l10n {
+/// Number of strings in an RT_STRING block
+static constexpr int stringsPerBlock = 16;
+
+/// Get the (1-based) RT_STRING block ID containing a string resource ID
+constexpr int StringBlockId(int resource_id) { return (resource_id / stringsPerBlock) + 1; }
+
+/**
+ * View RT_STRING resource data as UTF-16 code units.
+ * A trailing odd byte can't be part of any string and is ignored.
+ */
+std::span<const char16_t> StringBlockData(const void* data, size_t num_bytes);
+
+/**
+ * Parse an RT_STRING resource block.
+ * A block consists of 16 strings, each stored as a UTF-16 code unit giving the length,
+ * followed by that many code units of string data.
+ * \param block_data Contents of the block.
+ * \param strings Receives views of the strings in the block. Missing strings are empty.
+ * \returns Whether the block was well-formed. If it's truncated, all strings that
+ *   are completely contained in the data are still returned.
+ */
+bool ParseStringBlock(std::span<const char16_t> block_data, std::span<std::u16string_view, stringsPerBlock> strings);
+
+/**
+ * Flat lookup table for string resources.
+ * Stores views into the resource data, so that data must outlive the table.
+ */
+class StringTable
+{
+    /// Resource ID of the first entry in strings
+    int first_id = 0;
+    std::vector<std::u16string_view> strings;
+
+public:
+    /**
+     * Add the strings from an RT_STRING block.
+     * Strings already present in the table are kept, so to implement language fallback,
+     * add blocks in order of decreasing preference.
+     * \param block_id 1-based block ID (resource name) of the block.
+     * \param block_data Contents of the block.
+     * \returns Whether the block was well-formed.
+     */
+    bool AddBlock(int block_id, std::span<const char16_t> block_data);
+
+    /// Look up a string. Returns an empty view if the string is not present
+    std::u16string_view Find(int resource_id) const;
+    /// Number of non-empty strings in the table
+    size_t CountStrings() const;
+};
+} // namespace l10n
+
+#endif // COMMON_STRINGTABLE_H_
@@ -0,0 +1,169 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "SwitchCoalescer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace hdr {
+
+SwitchCoalescer::SwitchCoalescer(const Clock& clock) : SwitchCoalescer(clock, Settings()) { }
+
+SwitchCoalescer::SwitchCoalescer(const Clock& clock, const Settings& settings) : clock(clock), settings(settings) { }
+
+void SwitchCoalescer::SetMinInterval(Clock::duration interval)
+{
+    std::lock_guard lock(mutex);
+    settings.min_interval = interval;
+    changed.notify_all();
+}
+
+// Get the request resulting from toggling after another request
+static std::optional<SwitchCoalescer::Request> ToggleAfter(SwitchCoalescer::Request request)
+{
+    using Request = SwitchCoalescer::Request;
+    switch (request) {
+    case Request::Toggle:
+        // Two toggles in a row cancel each other out
+        return std::nullopt;
+    case Request::Enable:
+        return Request::Disable;
+    case Request::Disable:
+        return Request::Enable;
+    }
+    return std::nullopt;
+}
+
+uint64_t SwitchCoalescer::Add(Request request)
+{
+    std::lock_guard lock(mutex);
+    stats.requests++;
+    auto ticket = ++last_ticket;
+
+    if (pending) {
+        // Pending request is superseded
+        stats.coalesced++;
+        if (request == Request::Toggle) {
+            pending = ToggleAfter(*pending);
+            if (!pending) {
+                stats.coalesced++;
+                // Nothing left to do for the requests merged so far, once a running switch completed
+                if (running)
+                    running_ticket = ticket;
+                else
+                    done_ticket = ticket;
+            }
+        } else {
+            pending = request;
+        }
+    } else if (request == Request::Toggle && running && *running != Request::Toggle) {
+        // Resulting state of the running switch is known, so toggle relative to that
+        pending = ToggleAfter(*running);
+    } else {
+        pending = request;
+    }
+    changed.notify_all();
+    return ticket;
+}
+
+bool SwitchCoalescer::IsDone(uint64_t ticket) const
+{
+    std::lock_guard lock(mutex);
+    return ticket <= done_ticket;
+}
+
+bool SwitchCoalescer::IsBusy() const
+{
+    std::lock_guard lock(mutex);
+    return pending || running;
+}
+
+std::optional<Clock::duration> SwitchCoalescer::TimeUntilNextSwitch() const
+{
+    std::lock_guard lock(mutex);
+    if (!pending)
+        return std::nullopt;
+    if (!last_switch_end)
+        return Clock::duration::zero();
+    return std::max(*last_switch_end + settings.min_interval - clock.Now(), Clock::duration::zero());
+}
+
+std::optional<SwitchCoalescer::Request> SwitchCoalescer::BeginSwitch()
+{
+    std::lock_guard lock(mutex);
+    return BeginSwitchLocked();
+}
+
+std::optional<SwitchCoalescer::Request> SwitchCoalescer::BeginSwitchLocked()
+{
+    if (!pending || running)
+        return std::nullopt;
+    if (last_switch_end && clock.Now() < *last_switch_end + settings.min_interval)
+        return std::nullopt;
+
+    stats.executed++;
+    running = std::exchange(pending, std::nullopt);
+    running_ticket = last_ticket;
+    return running;
+}
+
+void SwitchCoalescer::EndSwitch()
+{
+    std::lock_guard lock(mutex);
+    running.reset();
+    last_switch_end = clock.Now();
+    done_ticket = std::max(done_ticket, running_ticket);
+    changed.notify_all();
+}
+
+std::optional<SwitchCoalescer::Request> SwitchCoalescer::WaitDone(uint64_t ticket)
+{
+    std::unique_lock lock(mutex);
+    while (ticket > done_ticket) {
+        // A request that's not done is either pending or part of the running switch
+        if (running || !pending) {
+            changed.wait(lock);
+            continue;
+        }
+        if (auto request = BeginSwitchLocked())
+            return request;
+        changed.wait_for(lock, *last_switch_end + settings.min_interval - clock.Now());
+    }
+    return std::nullopt;
+}
+
+SwitchCoalescer::Stats SwitchCoalescer::GetStats() const
+{
+    std::lock_guard lock(mutex);
+    return stats;
+}
+
+void SwitchCoalescer::ResetStats()
+{
+    std::lock_guard lock(mutex);
+    stats = {};
+}
+
+SwitchCoalescer& GetSwitchCoalescer()
+{
+    static SwitchCoalescer coalescer;
+    return coalescer;
+}
+
+} // namespace hdr
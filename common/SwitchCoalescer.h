@@ -0,0 +1,130 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_SWITCHCOALESCER_H_
+#define COMMON_SWITCHCOALESCER_H_
+
+#include "Clock.h"
+#include "HDR.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace hdr {
+/**
+ * Coalesces HDR switch requests and rate-limits the actual switches.
+ *
+ * Switching takes a while, and the driver may still be settling after a switch returned.
+ * So requests arriving while a switch is pending or running are merged into a single
+ * request for the final desired state, and consecutive switches are spaced by a minimum
+ * interval.
+ *
+ * The coalescer doesn't do any switching or waiting itself; the user is expected to wait
+ * for TimeUntilNextSwitch(), call BeginSwitch(), perform the returned request, and
+ * report completion with EndSwitch(). Methods may be called from any thread.
+ *
+ * With several threads adding requests, any of them may perform the merged switch;
+ * IsDone() tells each whether a switch covering its own request has completed. WaitDone()
+ * combines waiting and taking the pending request for threads that block anyway.
+ */
+class SwitchCoalescer
+{
+public:
+    enum class Request { Toggle, Enable, Disable };
+
+    struct Settings
+    {
+        /// Minimum time between the end of a switch and the start of the next one
+        Clock::duration min_interval = std::chrono::milliseconds(500);
+    };
+
+    struct Stats
+    {
+        /// Requests received
+        uint64_t requests = 0;
+        /// Requests that were merged with another one or cancelled out
+        uint64_t coalesced = 0;
+        /// Switches performed
+        uint64_t executed = 0;
+    };
+
+    explicit SwitchCoalescer(const Clock& clock = SteadyClock::Get());
+    SwitchCoalescer(const Clock& clock, const Settings& settings);
+
+    /// Set minimum time between switches
+    void SetMinInterval(Clock::duration interval);
+
+    /**
+     * Add a switch request.
+     * \returns Ticket for the request, to check with IsDone().
+     */
+    uint64_t Add(Request request);
+    /// Whether a switch including the request with the given ticket completed, or the request was cancelled out
+    bool IsDone(uint64_t ticket) const;
+    /// Whether a request is pending or a switch is running
+    bool IsBusy() const;
+    /// Time until the pending request may be performed. Not set if there's nothing to perform
+    std::optional<Clock::duration> TimeUntilNextSwitch() const;
+    /**
+     * Take the pending request, if it's due.
+     * \returns Request to perform. Not set if nothing is due, or another switch is still running.
+     */
+    std::optional<Request> BeginSwitch();
+    /// Report a switch was completed
+    void EndSwitch();
+    /**
+     * Wait until the request with the given ticket is done, or it's the caller's turn to switch.
+     * The minimum interval between switches is waited for in real time, so a virtual clock has to
+     * be advanced by another thread.
+     * \returns Request to perform, taken as with BeginSwitch(): the caller performs it, calls
+     *   EndSwitch() and waits again. Not set once the request is done.
+     */
+    std::optional<Request> WaitDone(uint64_t ticket);
+
+    Stats GetStats() const;
+    /// Reset statistics
+    void ResetStats();
+
+private:
+    const Clock& clock;
+    Settings settings;
+
+    mutable std::mutex mutex;
+    /// Notified when requests are added or a switch ends
+    std::condition_variable changed;
+    std::optional<Request> pending;
+    std::optional<Request> running;
+    std::optional<Clock::time_point> last_switch_end;
+    /// Ticket of the last request added
+    uint64_t last_ticket = 0;
+    /// Last ticket merged into the running switch
+    uint64_t running_ticket = 0;
+    /// All requests up to this ticket are done
+    uint64_t done_ticket = 0;
+    Stats stats;
+
+    std::optional<Request> BeginSwitchLocked();
+};
+
+/// Coalescer shared by all users in the process
+SwitchCoalescer& GetSwitchCoalescer();
+} // namespace hdr
+
+#endif // COMMON_SWITCHCOALESCER_H_
@@ -0,0 +1,193 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <map>
+#include <mutex>
+
+namespace hdr::trace {
+namespace detail {
+std::atomic<bool> enabled;
+} // namespace detail
+
+void SetEnabled(bool enable)
+{
+    detail::enabled.store(enable, std::memory_order_relaxed);
+}
+
+void Histogram::Add(std::chrono::nanoseconds duration)
+{
+    auto us = static_cast<uint64_t>(std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0));
+    auto bucket = std::min(static_cast<size_t>(std::bit_width(us)), numBuckets - 1);
+    buckets[bucket]++;
+    count++;
+    total += duration;
+    max = std::max(max, duration);
+}
+
+std::optional<std::chrono::nanoseconds> Histogram::GetBucketBound(size_t bucket)
+{
+    if (bucket >= numBuckets - 1)
+        return std::nullopt;
+    return std::chrono::microseconds(uint64_t(1) << bucket);
+}
+
+std::chrono::nanoseconds Histogram::GetPercentile(double fraction) const
+{
+    if (count == 0)
+        return {};
+    auto rank = static_cast<uint64_t>(fraction * count);
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < numBuckets; i++) {
+        cumulative += buckets[i];
+        if (cumulative > rank)
+            return std::min(GetBucketBound(i).value_or(max), max);
+    }
+    return max;
+}
+
+namespace {
+struct Key
+{
+    /// Span names are expected to be string literals, so no copy is needed
+    std::string_view name;
+    std::optional<TargetId> target;
+
+    auto operator<=>(const Key&) const = default;
+};
+
+struct Entry
+{
+    uint64_t failures = 0;
+    Histogram histogram;
+};
+} // anonymous namespace
+
+static std::mutex spans_mutex;
+static std::map<Key, Entry> spans;
+
+void Record(std::string_view name, const TargetId* target, std::chrono::nanoseconds duration, bool failed)
+{
+    if (!IsEnabled())
+        return;
+
+    Key key { name, target ? std::optional(*target) : std::nullopt };
+    std::lock_guard lock(spans_mutex);
+    auto& entry = spans[key];
+    entry.histogram.Add(duration);
+    if (failed)
+        entry.failures++;
+}
+
+std::vector<SpanStats> GetSpanStats()
+{
+    std::lock_guard lock(spans_mutex);
+    std::vector<SpanStats> result;
+    result.reserve(spans.size());
+    for (const auto& [key, entry] : spans)
+        result.push_back({ std::string(key.name), key.target, entry.failures, entry.histogram });
+    return result;
+}
+
+void Reset()
+{
+    std::lock_guard lock(spans_mutex);
+    spans.clear();
+}
+
+static std::string FormatTarget(const std::optional<TargetId>& target)
+{
+    if (!target)
+        return "-";
+    return std::format("{:08x}{:08x}:{}", static_cast<uint32_t>(target->adapter.high), target->adapter.low,
+                       target->id);
+}
+
+static std::string FormatDuration(std::chrono::nanoseconds duration)
+{
+    auto ns = duration.count();
+    if (ns < 1000)
+        return std::format("{}ns", ns);
+    if (ns < 1000'000)
+        return std::format("{:.1f}us", ns / 1e3);
+    if (ns < 1000'000'000)
+        return std::format("{:.1f}ms", ns / 1e6);
+    return std::format("{:.2f}s", ns / 1e9);
+}
+
+std::string FormatText(const std::vector<SpanStats>& spans)
+{
+    std::string output;
+    if (!IsEnabled())
+        output.append("Tracing is disabled\n");
+    if (spans.empty()) {
+        output.append("No spans recorded\n");
+        return output;
+    }
+
+    output.append(std::format("{:<28} {:<20} {:>7} {:>5} {:>9} {:>9} {:>9} {:>9}\n", "span", "target", "count",
+                              "fail", "p50", "p90", "p99", "max"));
+    for (const auto& span : spans) {
+        const auto& hist = span.histogram;
+        output.append(std::format("{:<28} {:<20} {:>7} {:>5} {:>9} {:>9} {:>9} {:>9}\n", span.name,
+                                  FormatTarget(span.target), hist.GetCount(), span.failures,
+                                  FormatDuration(hist.GetPercentile(0.5)), FormatDuration(hist.GetPercentile(0.9)),
+                                  FormatDuration(hist.GetPercentile(0.99)), FormatDuration(hist.GetMax())));
+    }
+    return output;
+}
+
+std::string FormatJson(const std::vector<SpanStats>& spans)
+{
+    std::string output = "[";
+    for (size_t i = 0; i < spans.size(); i++) {
+        const auto& span = spans[i];
+        const auto& hist = span.histogram;
+        if (i > 0)
+            output.push_back(',');
+        // Span names are plain identifiers, so need no escaping
+        output.append(std::format("{{\"name\":\"{}\",\"target\":", span.name));
+        output.append(span.target ? std::format("\"{}\"", FormatTarget(span.target)) : "null");
+        output.append(std::format(",\"count\":{},\"failures\":{},\"total_ns\":{},\"max_ns\":{},\"p50_ns\":{},"
+                                  "\"p90_ns\":{},\"p99_ns\":{},\"buckets\":[",
+                                  hist.GetCount(), span.failures, hist.GetTotal().count(), hist.GetMax().count(),
+                                  hist.GetPercentile(0.5).count(), hist.GetPercentile(0.9).count(),
+                                  hist.GetPercentile(0.99).count()));
+        bool first_bucket = true;
+        for (size_t b = 0; b < Histogram::numBuckets; b++) {
+            auto bucket_count = hist.GetBuckets()[b];
+            if (bucket_count == 0)
+                continue;
+            if (!first_bucket)
+                output.push_back(',');
+            first_bucket = false;
+            auto bound = Histogram::GetBucketBound(b);
+            output.append(std::format("{{\"lt_ns\":{},\"count\":{}}}",
+                                      bound ? std::to_string(bound->count()) : std::string("null"), bucket_count));
+        }
+        output.append("]}");
+    }
+    output.append("]\n");
+    return output;
+}
+} // namespace hdr::trace
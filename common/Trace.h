@@ -0,0 +1,115 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_TRACE_H_
+#define COMMON_TRACE_H_
+
+#include "HDR.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Lightweight tracing of time-consuming operations.
+ * Spans are identified by a name and optionally a display target, and their durations
+ * are collected in latency histograms. When tracing is disabled, recording costs
+ * a single atomic load.
+ */
+namespace hdr::trace {
+namespace detail {
+extern std::atomic<bool> enabled;
+} // namespace detail
+
+/// Whether spans are recorded
+inline bool IsEnabled()
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+/// Enable or disable recording spans
+void SetEnabled(bool enable);
+
+/**
+ * Latency histogram with fixed buckets.
+ * Bucket \c i counts durations below 2^i microseconds (and at least 2^(i-1) microseconds);
+ * the last bucket counts all longer durations.
+ */
+class Histogram
+{
+public:
+    static constexpr size_t numBuckets = 25;
+
+    void Add(std::chrono::nanoseconds duration);
+
+    uint64_t GetCount() const { return count; }
+    std::chrono::nanoseconds GetTotal() const { return total; }
+    std::chrono::nanoseconds GetMax() const { return max; }
+    const std::array<uint64_t, numBuckets>& GetBuckets() const { return buckets; }
+    /// Get exclusive upper bound of a bucket. Not set for the last bucket.
+    static std::optional<std::chrono::nanoseconds> GetBucketBound(size_t bucket);
+    /**
+     * Get an approximation of a percentile.
+     * \param fraction Percentile as a fraction (0..1).
+     * \returns Upper bound of the bucket containing the percentile, at most the maximum duration.
+     */
+    std::chrono::nanoseconds GetPercentile(double fraction) const;
+
+private:
+    uint64_t count = 0;
+    std::chrono::nanoseconds total {};
+    std::chrono::nanoseconds max {};
+    std::array<uint64_t, numBuckets> buckets = {};
+};
+
+/// Recorded data for a span
+struct SpanStats
+{
+    /// Name of the span
+    std::string name;
+    /// Display target the span is tagged with
+    std::optional<TargetId> target;
+    /// Number of spans that ended with a failure
+    uint64_t failures = 0;
+    Histogram histogram;
+};
+
+/**
+ * Record a span. Does nothing if tracing is disabled.
+ * \param name Name of the span.
+ * \param target Display target the span is tagged with. May be \c nullptr.
+ * \param duration Duration of the span.
+ * \param failed Whether the operation failed.
+ */
+void Record(std::string_view name, const TargetId* target, std::chrono::nanoseconds duration, bool failed = false);
+/// Get data for all recorded spans, sorted by name and target
+std::vector<SpanStats> GetSpanStats();
+/// Discard all recorded spans
+void Reset();
+
+/// Format span data as human-readable text
+std::string FormatText(const std::vector<SpanStats>& spans);
+/// Format span data as a JSON array
+std::string FormatJson(const std::vector<SpanStats>& spans);
+} // namespace hdr::trace
+
+#endif // COMMON_TRACE_H_
@@ -0,0 +1,60 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "TrayIcon.h"
+
+namespace tray {
+bool IconStateTracker::Add(const IconState& state)
+{
+    if (!shell.Add(state))
+        return false;
+    sent_state = state;
+    return true;
+}
+
+void IconStateTracker::Remove()
+{
+    shell.Delete();
+    sent_state.reset();
+}
+
+bool IconStateTracker::Update(const IconState& state)
+{
+    if (!sent_state)
+        return false;
+
+    unsigned fields = 0;
+    if (state.icon != sent_state->icon)
+        fields |= IconFieldIcon;
+    if (state.tip != sent_state->tip)
+        fields |= IconFieldTip;
+    if (!fields)
+        return true;
+
+    if (!shell.Modify(state, fields))
+        return false;
+    sent_state = state;
+    return true;
+}
+
+void IconStateTracker::InvalidateIcon()
+{
+    if (sent_state)
+        sent_state->icon = nullptr;
+}
+} // namespace tray
@@ -0,0 +1,93 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMMON_TRAYICON_H_
+#define COMMON_TRAYICON_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace tray {
+/// Visible state of a notification area icon
+struct IconState
+{
+    /// Icon handle
+    const void* icon = nullptr;
+    /// Tooltip text
+    std::wstring tip;
+};
+
+/// Notification area icon fields, used to tell which fields of an icon to change
+enum IconField : unsigned { IconFieldIcon = 1, IconFieldTip = 2 };
+
+/**
+ * Interface to the shell notification area.
+ * Each call is a round-trip to the shell, so it's worth avoiding calls.
+ */
+class Shell
+{
+public:
+    virtual ~Shell() = default;
+
+    /// Add the icon with the given state
+    virtual bool Add(const IconState& state) = 0;
+    /**
+     * Modify the icon.
+     * \param state New icon state.
+     * \param fields Combination of IconField values, telling which fields of \a state to apply.
+     */
+    virtual bool Modify(const IconState& state, unsigned fields) = 0;
+    /// Remove the icon
+    virtual bool Delete() = 0;
+    /// Show an error balloon
+    virtual bool ShowErrorBalloon(std::wstring_view text) = 0;
+};
+
+/**
+ * Keeps track of the icon state last sent to the shell,
+ * and only sends the changed fields, if any.
+ */
+class IconStateTracker
+{
+    Shell& shell;
+    /// Icon state last sent to the shell. Not set if the icon is not added.
+    std::optional<IconState> sent_state;
+
+public:
+    explicit IconStateTracker(Shell& shell) : shell(shell) { }
+
+    /// Whether the icon was added
+    bool IsAdded() const { return sent_state.has_value(); }
+    /// Add the icon
+    bool Add(const IconState& state);
+    /// Remove the icon
+    void Remove();
+    /**
+     * Update the icon state.
+     * Only changed fields are sent. Does nothing if the icon is not added.
+     * \returns Whether the icon is up-to-date.
+     */
+    bool Update(const IconState& state);
+    /// Force the icon to be sent on the next update, e.g. because icon handle values may have been reused
+    void InvalidateIcon();
+};
+} // namespace tray
+
+#endif // COMMON_TRAYICON_H_
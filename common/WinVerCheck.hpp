@@ -1,62 +0,0 @@
-/*
-    HDRTray, a notification icon for the "Use HDR" option
-    Copyright (C) 2024 Frank Richter
-
-    This program is free software: you can redistribute it and/or modify
-    it under the terms of the GNU General Public License as published by
-    the Free Software Foundation, either version 3 of the License, or
-    (at your option) any later version.
-
-    This program is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with this program.  If not, see <https://www.gnu.org/licenses/>.
-*/
-
-#ifndef WINVERCHECK_HPP_
-#define WINVERCHECK_HPP_
-
-#include "framework.h"
-#include "VersionHelpers.h"
-
-static bool IsWindows10BuildOrGreater(DWORD dwBuildNumber)
-{
-    OSVERSIONINFOEXW osvi = { sizeof(osvi), 0, 0, 0, 0, {0}, 0, 0 };
-    DWORDLONG        const dwlConditionMask = VerSetConditionMask(
-        VerSetConditionMask(
-        VerSetConditionMask(
-            0, VER_MAJORVERSION, VER_GREATER_EQUAL),
-               VER_MINORVERSION, VER_GREATER_EQUAL),
-               VER_BUILDNUMBER, VER_GREATER_EQUAL);
-
-    osvi.dwMajorVersion = 10;
-    osvi.dwMinorVersion = 0;
-    osvi.dwBuildNumber = dwBuildNumber;
-
-    return VerifyVersionInfoW(&osvi, VER_MAJORVERSION | VER_MINORVERSION | VER_BUILDNUMBER, dwlConditionMask) != FALSE;
-}
-
-static bool IsWindows10_1709OrGreater ()
-{
-    return IsWindows10BuildOrGreater(16299);
-}
-
-static bool IsWindows10_1803OrGreater ()
-{
-    return IsWindows10BuildOrGreater(17134);
-}
-
-static bool IsWindows10_1903OrGreater ()
-{
-    return IsWindows10BuildOrGreater(18362);
-}
-
-static bool IsWindows11_24H2OrGreater ()
-{
-    return IsWindows10BuildOrGreater(26100);
-}
-
-#endif // WINVERCHECK_HPP_
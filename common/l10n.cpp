@@ -18,14 +18,18 @@
 
 #include "l10n.h"
 
-#include <utility>
+#include "StringTable.h"
+
+#include <vector>
 
 #include "framework.h"
 
 namespace l10n {
-static std::wstring_view LoadStringLang(int resource_id, WORD lang)
+static_assert(sizeof(wchar_t) == sizeof(char16_t), "wchar_t expected to be UTF-16");
+
+static std::span<const char16_t> GetStringBlockData(int block_id, WORD lang)
 {
-    HRSRC string_block = FindResourceExW(NULL, RT_STRING, MAKEINTRESOURCEW((resource_id / 16) + 1), lang);
+    HRSRC string_block = FindResourceExW(NULL, RT_STRING, MAKEINTRESOURCEW(block_id), lang);
     if (!string_block)
         return {};
 
@@ -35,31 +39,46 @@ static std::wstring_view LoadStringLang(int resource_id, WORD lang)
     HGLOBAL data_handle = LoadResource(NULL, string_block);
     if (!data_handle)
         return {};
-    const uint8_t* data_ptr = reinterpret_cast<uint8_t*>(LockResource(data_handle));
+    const void* data_ptr = LockResource(data_handle);
     if (!data_ptr)
         return {};
-    const uint8_t* data_end = data_ptr + res_size;
-    int string_block_idx = resource_id % 16;
-    int current_idx = 0;
-    while (data_ptr < data_end) {
-        uint16_t string_len;
-        memcpy(&string_len, data_ptr, sizeof(uint16_t));
-        data_ptr += sizeof(uint16_t);
-        if (current_idx == string_block_idx)
-            return std::wstring_view(reinterpret_cast<const wchar_t*>(data_ptr), string_len);
-        data_ptr += string_len * sizeof(wchar_t);
-        ++current_idx;
+    return StringBlockData(data_ptr, res_size);
+}
+
+static BOOL CALLBACK CollectStringBlockId(HMODULE, LPCWSTR, LPWSTR name, LONG_PTR param)
+{
+    if (IS_INTRESOURCE(name))
+        reinterpret_cast<std::vector<int>*>(param)->push_back(static_cast<int>(reinterpret_cast<uintptr_t>(name)));
+    return TRUE;
+}
+
+static StringTable BuildStringTable()
+{
+    std::vector<int> block_ids;
+    EnumResourceNamesW(NULL, RT_STRING, CollectStringBlockId, reinterpret_cast<LONG_PTR>(&block_ids));
+
+    /* Resource data stays mapped for the lifetime of the process,
+     * so the table can just reference it. */
+    StringTable table;
+    for (WORD lang : { MAKELANGID(LANG_NEUTRAL, SUBLANG_NEUTRAL),
+                       // Fall back to en-US
+                       MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US) }) {
+        for (int block_id : block_ids)
+            table.AddBlock(block_id, GetStringBlockData(block_id, lang));
     }
-    return {};
+    return table;
+}
+
+static const StringTable& GetStringTable()
+{
+    static const StringTable table = BuildStringTable();
+    return table;
 }
 
 std::wstring_view LoadString(int resource_id)
 {
-    auto str = LoadStringLang(resource_id, MAKELANGID(LANG_NEUTRAL, SUBLANG_NEUTRAL));
-    // Fall back to en-US
-    if (str.empty())
-        str = LoadStringLang(resource_id, MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US));
-    return str;
+    auto str = GetStringTable().Find(resource_id);
+    return std::wstring_view(reinterpret_cast<const wchar_t*>(str.data()), str.size());
 }
 
 void LoadString(int resource_id, std::span<wchar_t> dest)
@@ -27,6 +27,7 @@ namespace l10n {
 /**
  * Load a string from a resource.
  * Unlike Win32 load string, falls back to en-US if _any_ string isn't found.
+ * All strings are indexed on first use, so lookups don't involve any resource API calls.
  * \param dest Buffer that receives the string.
  */
 std::wstring_view LoadString(int resource_id);
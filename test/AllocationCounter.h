@@ -0,0 +1,29 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_ALLOCATIONCOUNTER_H_
+#define TEST_ALLOCATIONCOUNTER_H_
+
+#include <cstdint>
+
+namespace test {
+/// Number of heap allocations made by the test program so far
+uint64_t CountAllocations();
+} // namespace test
+
+#endif // TEST_ALLOCATIONCOUNTER_H_
@@ -0,0 +1,95 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include "AutostartMemory.h"
+
+static const wchar_t value_name[] = L"HDRTray";
+static const wchar_t command[] = L"\"C:\\Program Files\\HDRTray\\HDRTray.exe\"";
+
+TEST_CASE(Autostart, CachedUntilKeyChanges)
+{
+    autostart::MemoryRunKey key;
+    autostart::AutostartState state(key, value_name, command);
+    CHECK(!state.IsEnabled());
+    CHECK(key.GetStats().queries == 1);
+
+    for (int i = 0; i < 100; i++)
+        CHECK(!state.IsEnabled());
+    CHECK(key.GetStats().queries == 1);
+    CHECK(state.GetStats().queries == 101);
+    CHECK(state.GetStats().reads == 1);
+}
+
+TEST_CASE(Autostart, ExternalSetInvalidates)
+{
+    autostart::MemoryRunKey key;
+    autostart::AutostartState state(key, value_name, command);
+    CHECK(!state.IsEnabled());
+
+    key.ExternalSetValue(value_name, command);
+    CHECK(state.IsEnabled());
+    CHECK(state.IsEnabled());
+    CHECK(state.GetStats().reads == 2);
+}
+
+TEST_CASE(Autostart, ExternalDeleteInvalidates)
+{
+    autostart::MemoryRunKey key;
+    key.ExternalSetValue(value_name, command);
+    autostart::AutostartState state(key, value_name, command);
+    CHECK(state.IsEnabled());
+
+    key.ExternalDeleteValue(value_name);
+    CHECK(!state.IsEnabled());
+    CHECK(state.GetStats().reads == 2);
+}
+
+TEST_CASE(Autostart, OtherCommandNotEnabled)
+{
+    autostart::MemoryRunKey key;
+    key.ExternalSetValue(value_name, L"C:\\Elsewhere\\HDRTray.exe");
+    autostart::AutostartState state(key, value_name, command);
+    CHECK(!state.IsEnabled());
+}
+
+TEST_CASE(Autostart, CommandCaseIgnored)
+{
+    autostart::MemoryRunKey key;
+    key.ExternalSetValue(value_name, L"\"c:\\program files\\hdrtray\\HDRTRAY.EXE\"");
+    autostart::AutostartState state(key, value_name, command);
+    CHECK(state.IsEnabled());
+}
+
+TEST_CASE(Autostart, SetEnabledUpdatesCache)
+{
+    autostart::MemoryRunKey key;
+    autostart::AutostartState state(key, value_name, command);
+    CHECK(!state.IsEnabled());
+
+    CHECK(state.SetEnabled(true));
+    CHECK(key.GetStats().sets == 1);
+    CHECK(key.QueryValue(value_name) == std::wstring(command));
+    CHECK(state.IsEnabled());
+
+    CHECK(state.SetEnabled(false));
+    CHECK(key.GetStats().deletes == 1);
+    CHECK(!key.QueryValue(value_name));
+    CHECK(!state.IsEnabled());
+}
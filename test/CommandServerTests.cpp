@@ -0,0 +1,113 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include "CommandServer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <format>
+#include <mutex>
+#include <thread>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// Endpoint unique to this process, so tests can run in parallel
+static std::string TestEndpoint()
+{
+#if defined(_WIN32)
+    return std::format("hdr_tests-{}", _getpid());
+#else
+    return std::format("hdr_tests-{}", getpid());
+#endif
+}
+
+TEST_CASE(CommandServer, ClientsServedConcurrently)
+{
+    auto endpoint = TestEndpoint();
+    auto listener = hdr::ipc::Listen(endpoint);
+    CHECK(listener);
+    if (!listener)
+        return;
+
+    // "wait" only returns once "release" was received on another connection
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool released = false;
+    std::thread server_thread([&]() {
+        hdr::ServeCommands(*listener, endpoint, [&](std::string_view command) {
+            std::unique_lock lock(mutex);
+            if (command == "release") {
+                released = true;
+                cond.notify_all();
+                return hdr::CommandResult { 0, "released" };
+            }
+            bool ok = cond.wait_for(lock, std::chrono::seconds(5), [&]() { return released; });
+            return hdr::CommandResult { ok ? 0 : 1, "waited" };
+        });
+    });
+
+    std::optional<hdr::CommandResult> wait_result;
+    std::thread waiting_client([&]() {
+        if (auto connection = hdr::ipc::Connect(endpoint))
+            wait_result = hdr::SendCommand(*connection, "wait");
+    });
+    auto connection = hdr::ipc::Connect(endpoint);
+    CHECK(connection);
+    if (connection) {
+        auto release_result = hdr::SendCommand(*connection, "release");
+        CHECK(release_result && release_result->output == "released");
+    }
+    waiting_client.join();
+    CHECK(wait_result && wait_result->exit_code == 0 && wait_result->output == "waited");
+
+    auto stop_connection = hdr::ipc::Connect(endpoint);
+    CHECK(stop_connection && hdr::SendCommand(*stop_connection, hdr::shutdown_command));
+    stop_connection.reset();
+    connection.reset();
+    server_thread.join();
+}
+
+TEST_CASE(CommandServer, StopsWithIdleClient)
+{
+    auto endpoint = TestEndpoint();
+    auto listener = hdr::ipc::Listen(endpoint);
+    CHECK(listener);
+    if (!listener)
+        return;
+
+    std::thread server_thread([&]() {
+        hdr::ServeCommands(*listener, endpoint, [](std::string_view) { return hdr::CommandResult { 0, "pong" }; });
+    });
+
+    // Client that stays connected after its command, so the server waits for its next line
+    auto idle_connection = hdr::ipc::Connect(endpoint);
+    CHECK(idle_connection && hdr::SendCommand(*idle_connection, "ping"));
+
+    auto stop_connection = hdr::ipc::Connect(endpoint);
+    CHECK(stop_connection && hdr::SendCommand(*stop_connection, hdr::shutdown_command));
+    server_thread.join();
+
+    // The server disconnected the idle client
+    CHECK(!idle_connection || !hdr::SendCommand(*idle_connection, "ping"));
+}
@@ -0,0 +1,80 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include "DisplayIndex.h"
+
+// Display with target id and connector instance \a n
+static hdr::DisplayIdentity MakeIdentity(uint32_t n, std::wstring name)
+{
+    hdr::DisplayIdentity identity;
+    identity.id = { { 1, 0 }, n };
+    identity.name = std::move(name);
+    identity.connector = { { 1, 0 }, 5, n };
+    return identity;
+}
+
+TEST_CASE(DisplayIndex, LookupById)
+{
+    hdr::DisplayIndex index;
+    CHECK(index.Update({ MakeIdentity(3, L"B"), MakeIdentity(1, L"A") }));
+    CHECK(index.GetDisplays().size() == 2);
+    CHECK(index.GetDisplays()[0].id.id == 1);
+
+    const auto* display = index.FindById({ { 1, 0 }, 3 });
+    CHECK(display && display->name == L"B");
+    CHECK(!index.FindById({ { 2, 0 }, 3 }));
+    CHECK(index.FindByConnector({ { 1, 0 }, 5, 3 }) == display);
+}
+
+TEST_CASE(DisplayIndex, LookupByIndexUsesReportedOrder)
+{
+    hdr::DisplayIndex index;
+    index.Update({ MakeIdentity(3, L"B"), MakeIdentity(1, L"A") });
+    const auto* first = index.FindByIndex(0);
+    CHECK(first && first->id.id == 3);
+    const auto* second = index.FindByIndex(1);
+    CHECK(second && second->id.id == 1);
+    CHECK(!index.FindByIndex(2));
+
+    // Same displays, other order
+    CHECK(index.Update({ MakeIdentity(1, L"A"), MakeIdentity(3, L"B") }));
+    first = index.FindByIndex(0);
+    CHECK(first && first->id.id == 1);
+}
+
+TEST_CASE(DisplayIndex, LookupByNameIgnoresCase)
+{
+    hdr::DisplayIndex index;
+    index.Update({ MakeIdentity(1, L"DELL U2720Q"), MakeIdentity(2, L"Other"), MakeIdentity(3, L"Dell U2720Q") });
+    auto dells = index.FindByName(L"dell u2720q");
+    CHECK(dells.size() == 2 && dells[0]->id.id == 1 && dells[1]->id.id == 3);
+    CHECK(index.FindByName(L"OTHER").size() == 1);
+    CHECK(index.FindByName(L"Dell").empty());
+}
+
+TEST_CASE(DisplayIndex, UnchangedUpdateKeepsEntries)
+{
+    hdr::DisplayIndex index;
+    index.Update({ MakeIdentity(1, L"A"), MakeIdentity(2, L"B") });
+    const auto* display = index.FindById({ { 1, 0 }, 2 });
+
+    CHECK(!index.Update({ MakeIdentity(1, L"A"), MakeIdentity(2, L"B") }));
+    CHECK(index.FindById({ { 1, 0 }, 2 }) == display);
+}
@@ -0,0 +1,59 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* libFuzzer entry point for the RT_STRING block parser.
+ * The first two bytes of the input select a block id, the rest is the block data. */
+
+#include "StringTable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    if (size < 2)
+        return 0;
+    int block_id = data[0] | (data[1] << 8);
+    // Copy, so the data is suitably aligned, and accesses past the end are caught
+    std::vector<char16_t> block_buffer((size - 2 + 1) / sizeof(char16_t));
+    if (size > 2)
+        std::memcpy(block_buffer.data(), data + 2, size - 2);
+    auto block_data = l10n::StringBlockData(block_buffer.data(), size - 2);
+
+    std::u16string_view strings[l10n::stringsPerBlock];
+    l10n::ParseStringBlock(block_data, strings);
+    for (auto str : strings) {
+        // All strings must lie within the block data
+        if (!str.empty()
+            && (str.data() < block_data.data() || str.data() + str.size() > block_data.data() + block_data.size()))
+            std::abort();
+    }
+
+    l10n::StringTable table;
+    table.AddBlock(block_id, block_data);
+    table.AddBlock(block_id + 1, block_data);
+    int first_id = (block_id - 1) * l10n::stringsPerBlock;
+    for (int i = 0; i < l10n::stringsPerBlock; i++) {
+        if (block_id >= 1 && table.Find(first_id + i) != strings[i])
+            std::abort();
+    }
+    return 0;
+}
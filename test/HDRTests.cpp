@@ -0,0 +1,190 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "ScopedBackend.h"
+
+#include "DisplayConfigSim.h"
+#include "HDR.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using hdr::display_config::Call;
+using hdr::display_config::MakeExtendedTopology;
+using hdr::display_config::SimulatedBackend;
+
+static uint64_t CountFailures(const SimulatedBackend& backend, Call call)
+{
+    return backend.GetStats(call).failures;
+}
+
+// Display that doesn't support the 24H2 functions, on an OS that does
+static SimulatedBackend MakeLegacyDisplayBackend()
+{
+    auto displays = MakeExtendedTopology(1);
+    displays[0].hdr_state_functions = false;
+    return SimulatedBackend(displays);
+}
+
+TEST_CASE(HDR, QueryProbesOnce)
+{
+    auto backend = MakeLegacyDisplayBackend();
+    test::ScopedBackend scoped_backend(backend);
+
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Off);
+    CHECK(CountFailures(backend, Call::GetAdvancedColorInfo2) == 1);
+
+    for (int i = 0; i < 10; i++) {
+        hdr::InvalidateStatus();
+        CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Off);
+    }
+    CHECK(CountFailures(backend, Call::GetAdvancedColorInfo2) == 1);
+    CHECK(backend.GetStats(Call::GetAdvancedColorInfo).count == 11);
+
+    auto displays = hdr::GetDisplays();
+    CHECK(displays.size() == 1 && displays[0].api == hdr::ApiGeneration::Legacy);
+}
+
+TEST_CASE(HDR, SetProbesOnce)
+{
+    auto backend = MakeLegacyDisplayBackend();
+    test::ScopedBackend scoped_backend(backend);
+
+    CHECK(hdr::SetWindowsHDRStatus(true) == hdr::Status::On);
+    CHECK(CountFailures(backend, Call::SetHdrState) == 1);
+
+    for (int i = 0; i < 10; i++)
+        hdr::ToggleHDRStatus();
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::On);
+    CHECK(CountFailures(backend, Call::SetHdrState) == 1);
+    CHECK(CountFailures(backend, Call::SetAdvancedColorState) == 0);
+    CHECK(backend.GetStats(Call::SetAdvancedColorState).count == 11);
+}
+
+TEST_CASE(HDR, NoProbeWithoutOsSupport)
+{
+    SimulatedBackend backend(MakeExtendedTopology(2));
+    backend.SetHasHdrStateFunctions(false);
+    test::ScopedBackend scoped_backend(backend);
+
+    hdr::GetWindowsHDRStatus();
+    hdr::SetWindowsHDRStatus(true);
+    hdr::SetWindowsHDRStatus(false);
+    CHECK(backend.GetStats(Call::GetAdvancedColorInfo2).count == 0);
+    CHECK(backend.GetStats(Call::SetHdrState).count == 0);
+    CHECK(CountFailures(backend, Call::GetAdvancedColorInfo) == 0);
+    CHECK(CountFailures(backend, Call::SetAdvancedColorState) == 0);
+}
+
+TEST_CASE(HDR, ProbeAgainAfterTopologyChange)
+{
+    auto backend = MakeLegacyDisplayBackend();
+    test::ScopedBackend scoped_backend(backend);
+
+    hdr::GetWindowsHDRStatus();
+    hdr::InvalidateTopology();
+    hdr::GetWindowsHDRStatus();
+    CHECK(CountFailures(backend, Call::GetAdvancedColorInfo2) == 2);
+}
+
+TEST_CASE(HDR, PrefersNewApi)
+{
+    SimulatedBackend backend(MakeExtendedTopology(1));
+    test::ScopedBackend scoped_backend(backend);
+
+    hdr::SetWindowsHDRStatus(true);
+    hdr::InvalidateStatus();
+    hdr::GetWindowsHDRStatus();
+    CHECK(backend.GetStats(Call::GetAdvancedColorInfo).count == 0);
+    CHECK(backend.GetStats(Call::SetAdvancedColorState).count == 0);
+    CHECK(hdr::GetDisplays().at(0).api == hdr::ApiGeneration::Win11_24H2);
+}
+
+TEST_CASE(HDR, TransientFailureNotMemoized)
+{
+    SimulatedBackend backend(MakeExtendedTopology(1));
+    test::ScopedBackend scoped_backend(backend);
+
+    // One failure of each 24H2 function, unrelated to support for it
+    backend.SetFailureRate(Call::GetAdvancedColorInfo2, 1);
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Off);
+    backend.SetFailureRate(Call::GetAdvancedColorInfo2, 0);
+    backend.SetFailureRate(Call::SetHdrState, 1);
+    CHECK(hdr::SetWindowsHDRStatus(true) == hdr::Status::On);
+    backend.SetFailureRate(Call::SetHdrState, 0);
+    CHECK(CountFailures(backend, Call::GetAdvancedColorInfo2) == 1);
+    CHECK(CountFailures(backend, Call::SetHdrState) == 1);
+
+    // Both are used again afterwards
+    CHECK(hdr::SetWindowsHDRStatus(false) == hdr::Status::Off);
+    CHECK(backend.GetStats(Call::SetHdrState).count == 2);
+    CHECK(backend.GetStats(Call::SetAdvancedColorState).count == 1);
+    CHECK(hdr::GetDisplays().at(0).api == hdr::ApiGeneration::Win11_24H2);
+}
+
+namespace {
+/// Simulated backend recording how many SetHdrState() calls were in flight at once, per requested state
+class ConcurrencyBackend : public SimulatedBackend
+{
+    std::atomic<int> in_flight[2] = {};
+
+public:
+    std::atomic<int> max_in_flight[2] = {};
+
+    using SimulatedBackend::SimulatedBackend;
+
+protected:
+    hdr::display_config::CallResult DoSetHdrState(const hdr::TargetId& target, bool enable) override
+    {
+        int current = ++in_flight[enable];
+        int max = max_in_flight[enable].load();
+        while (current > max && !max_in_flight[enable].compare_exchange_weak(max, current)) {}
+        auto result = SimulatedBackend::DoSetHdrState(target, enable);
+        --in_flight[enable];
+        return result;
+    }
+};
+} // anonymous namespace
+
+TEST_CASE(HDR, SwitchModePerCall)
+{
+    ConcurrencyBackend backend(MakeExtendedTopology(4, 4));
+    backend.SetLatency(Call::SetHdrState, std::chrono::milliseconds(5));
+    test::ScopedBackend scoped_backend(backend);
+
+    // Switching on in parallel while another thread switches off sequentially must not affect either
+    std::atomic<bool> start = false;
+    std::thread parallel_thread([&]() {
+        while (!start.load()) {}
+        for (int i = 0; i < 5; i++)
+            hdr::SetWindowsHDRStatus(true, hdr::SwitchMode::Parallel);
+    });
+    std::thread sequential_thread([&]() {
+        while (!start.load()) {}
+        for (int i = 0; i < 5; i++)
+            hdr::SetWindowsHDRStatus(false, hdr::SwitchMode::Sequential);
+    });
+    start = true;
+    parallel_thread.join();
+    sequential_thread.join();
+
+    CHECK(backend.max_in_flight[true].load() > 1);
+    CHECK(backend.max_in_flight[false].load() == 1);
+}
@@ -0,0 +1,137 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include "RecheckScheduler.h"
+
+#include <vector>
+
+using namespace std::chrono_literals;
+using hdr::Clock;
+using hdr::RecheckScheduler;
+using hdr::VirtualClock;
+
+/* Run re-checks that never detect a change until the scheduler goes idle.
+ * Returns the check times, relative to the start */
+static std::vector<Clock::duration> RunUnchangedChecks(VirtualClock& clock, RecheckScheduler& scheduler)
+{
+    auto start = clock.Now();
+    std::vector<Clock::duration> check_times;
+    while (auto wait = scheduler.TimeUntilNextCheck()) {
+        clock.Advance(*wait);
+        CHECK(scheduler.CheckDue());
+        check_times.push_back(clock.Now() - start);
+        scheduler.CheckDone(false);
+    }
+    return check_times;
+}
+
+TEST_CASE(RecheckScheduler, ChecksRightAway)
+{
+    VirtualClock clock;
+    RecheckScheduler scheduler(clock);
+    CHECK(scheduler.IsIdle());
+    CHECK(!scheduler.CheckDue());
+
+    scheduler.NotifyChange();
+    CHECK(scheduler.CheckDue());
+    CHECK(scheduler.TimeUntilNextCheck() == Clock::duration::zero());
+}
+
+TEST_CASE(RecheckScheduler, BackoffSchedule)
+{
+    VirtualClock clock;
+    RecheckScheduler scheduler(clock);
+    scheduler.NotifyChange();
+
+    // Intervals double from 100 ms up to 1600 ms; the last check is at the 5 s limit
+    std::vector<Clock::duration> expected = { 0ms, 100ms, 300ms, 700ms, 1500ms, 3100ms, 4700ms, 5000ms };
+    CHECK(RunUnchangedChecks(clock, scheduler) == expected);
+    CHECK(scheduler.IsIdle());
+    CHECK(scheduler.GetStats().checks == expected.size());
+}
+
+TEST_CASE(RecheckScheduler, NotDueEarly)
+{
+    VirtualClock clock;
+    RecheckScheduler scheduler(clock);
+    scheduler.NotifyChange();
+    scheduler.CheckDone(false);
+
+    clock.Advance(99ms);
+    CHECK(!scheduler.CheckDue());
+    CHECK(scheduler.TimeUntilNextCheck() == Clock::duration(1ms));
+    clock.Advance(1ms);
+    CHECK(scheduler.CheckDue());
+}
+
+TEST_CASE(RecheckScheduler, IdleAfterChange)
+{
+    VirtualClock clock;
+    RecheckScheduler scheduler(clock);
+    scheduler.NotifyChange();
+    scheduler.CheckDone(false);
+    clock.Advance(100ms);
+    scheduler.CheckDone(true);
+    CHECK(scheduler.IsIdle());
+    CHECK(!scheduler.TimeUntilNextCheck());
+}
+
+TEST_CASE(RecheckScheduler, NewChangeRestartsBackoff)
+{
+    VirtualClock clock;
+    RecheckScheduler scheduler(clock);
+    scheduler.NotifyChange();
+    scheduler.CheckDone(false);
+    clock.Advance(100ms);
+    scheduler.CheckDone(false);
+    clock.Advance(200ms);
+    scheduler.CheckDone(false);
+
+    // Change event while re-checking: coalesced, and the interval starts over
+    clock.Advance(10ms);
+    scheduler.NotifyChange();
+    CHECK(scheduler.TimeUntilNextCheck() == Clock::duration(50ms));
+    clock.Advance(50ms);
+    scheduler.CheckDone(false);
+    CHECK(scheduler.TimeUntilNextCheck() == Clock::duration(100ms));
+}
+
+TEST_CASE(RecheckScheduler, BurstCoalesced)
+{
+    VirtualClock clock;
+    RecheckScheduler scheduler(clock);
+    scheduler.NotifyChange();
+    scheduler.CheckDone(false);
+
+    // A change event every 20 ms: checks are postponed, but by at most 250 ms
+    std::vector<Clock::duration> check_times;
+    for (int tick = 1; tick <= 500; tick++) {
+        clock.Advance(1ms);
+        if (tick % 20 == 0)
+            scheduler.NotifyChange();
+        if (scheduler.CheckDue()) {
+            check_times.push_back(Clock::duration(tick * 1ms));
+            scheduler.CheckDone(false);
+        }
+    }
+    CHECK(!check_times.empty() && check_times.front() == Clock::duration(270ms));
+    CHECK(scheduler.GetStats().events == 26);
+    CHECK(scheduler.GetStats().coalesced_events == 25);
+}
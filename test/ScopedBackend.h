@@ -0,0 +1,37 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_SCOPEDBACKEND_H_
+#define TEST_SCOPEDBACKEND_H_
+
+#include "DisplayConfig.h"
+
+namespace test {
+/// Use a display configuration backend for the hdr:: functions while in scope
+class ScopedBackend
+{
+public:
+    explicit ScopedBackend(hdr::display_config::Backend& backend) { hdr::display_config::SetBackend(&backend); }
+    ~ScopedBackend() { hdr::display_config::SetBackend(nullptr); }
+
+    ScopedBackend(const ScopedBackend&) = delete;
+    ScopedBackend& operator=(const ScopedBackend&) = delete;
+};
+} // namespace test
+
+#endif // TEST_SCOPEDBACKEND_H_
@@ -0,0 +1,140 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "ScopedBackend.h"
+
+#include "DisplayConfigSim.h"
+#include "StatusWatcher.h"
+
+using namespace std::chrono_literals;
+using hdr::display_config::MakeExtendedTopology;
+using hdr::display_config::SimulatedBackend;
+
+// Change the HDR state of a simulated display behind the watcher's back
+static void SetSimulatedHdr(SimulatedBackend& backend, size_t index, bool enabled)
+{
+    auto displays = backend.GetDisplays();
+    displays.at(index).hdr_enabled = enabled;
+    backend.SetDisplays(std::move(displays));
+}
+
+// Advance the clock to the next scheduled check and poll
+static std::vector<hdr::StatusTransition> PollNext(hdr::VirtualClock& clock, hdr::StatusWatcher& watcher)
+{
+    if (auto wait = watcher.TimeUntilNextCheck())
+        clock.Advance(*wait);
+    return watcher.Poll();
+}
+
+TEST_CASE(StatusWatcher, ReportsTransition)
+{
+    SimulatedBackend backend(MakeExtendedTopology(1));
+    test::ScopedBackend scoped_backend(backend);
+    hdr::VirtualClock clock;
+    hdr::StatusWatcher watcher(clock);
+    CHECK(watcher.Poll().empty());
+
+    clock.Advance(10s);
+    SetSimulatedHdr(backend, 0, true);
+    watcher.NotifyChange();
+    auto transitions = watcher.Poll();
+    CHECK(transitions.size() == 1);
+    if (!transitions.empty()) {
+        const auto& transition = transitions[0];
+        CHECK(transition.time == clock.Now());
+        CHECK(transition.id == backend.GetDisplays()[0].target);
+        CHECK(transition.name == L"Display 1");
+        CHECK(transition.old_status == hdr::Status::Off);
+        CHECK(transition.new_status == hdr::Status::On);
+    }
+    // The only display changed: nothing left to wait for
+    CHECK(!watcher.TimeUntilNextCheck());
+}
+
+TEST_CASE(StatusWatcher, WaitsForAllDisplays)
+{
+    SimulatedBackend backend(MakeExtendedTopology(2));
+    test::ScopedBackend scoped_backend(backend);
+    hdr::VirtualClock clock;
+    hdr::StatusWatcher watcher(clock);
+
+    SetSimulatedHdr(backend, 0, true);
+    watcher.NotifyChange();
+    CHECK(PollNext(clock, watcher).size() == 1);
+    CHECK(watcher.TimeUntilNextCheck().has_value());
+
+    // Second display settles a bit later
+    CHECK(PollNext(clock, watcher).empty());
+    SetSimulatedHdr(backend, 1, true);
+    auto transitions = PollNext(clock, watcher);
+    CHECK(transitions.size() == 1 && transitions[0].id == backend.GetDisplays()[1].target);
+    CHECK(!watcher.TimeUntilNextCheck());
+}
+
+TEST_CASE(StatusWatcher, UnsupportedDisplayNotPending)
+{
+    auto displays = MakeExtendedTopology(2);
+    displays[1].hdr_supported = false;
+    SimulatedBackend backend(displays);
+    test::ScopedBackend scoped_backend(backend);
+    hdr::VirtualClock clock;
+    hdr::StatusWatcher watcher(clock);
+
+    SetSimulatedHdr(backend, 0, true);
+    watcher.NotifyChange();
+    CHECK(PollNext(clock, watcher).size() == 1);
+    CHECK(!watcher.TimeUntilNextCheck());
+}
+
+TEST_CASE(StatusWatcher, GivesUpWithoutChange)
+{
+    SimulatedBackend backend(MakeExtendedTopology(2));
+    test::ScopedBackend scoped_backend(backend);
+    hdr::VirtualClock clock;
+    hdr::StatusWatcher watcher(clock);
+
+    auto start = clock.Now();
+    watcher.NotifyChange();
+    while (watcher.TimeUntilNextCheck())
+        CHECK(PollNext(clock, watcher).empty());
+    CHECK(clock.Now() - start == hdr::Clock::duration(5s));
+    CHECK(watcher.GetStats().checks == 8);
+}
+
+TEST_CASE(StatusWatcher, DisplaysAddedAndRemoved)
+{
+    SimulatedBackend backend(MakeExtendedTopology(1));
+    test::ScopedBackend scoped_backend(backend);
+    hdr::VirtualClock clock;
+    hdr::StatusWatcher watcher(clock);
+
+    backend.SetDisplays(MakeExtendedTopology(2));
+    watcher.NotifyChange();
+    auto transitions = PollNext(clock, watcher);
+    CHECK(transitions.size() == 1 && !transitions[0].old_status && transitions[0].new_status == hdr::Status::Off);
+
+    // Let re-checking run out
+    while (watcher.TimeUntilNextCheck())
+        PollNext(clock, watcher);
+
+    backend.SetDisplays(MakeExtendedTopology(1));
+    watcher.NotifyChange();
+    transitions = PollNext(clock, watcher);
+    CHECK(transitions.size() == 1 && transitions[0].old_status == hdr::Status::Off && !transitions[0].new_status);
+}
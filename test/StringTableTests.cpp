@@ -0,0 +1,151 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include "StringTable.h"
+
+#include <array>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+using l10n::stringsPerBlock;
+
+// Build RT_STRING block data. Missing strings are stored as empty
+static std::u16string MakeBlock(std::initializer_list<std::u16string_view> strings)
+{
+    std::u16string data;
+    size_t num_strings = 0;
+    for (auto str : strings) {
+        data.push_back(static_cast<char16_t>(str.size()));
+        data.append(str);
+        num_strings++;
+    }
+    for (; num_strings < stringsPerBlock; num_strings++)
+        data.push_back(0);
+    return data;
+}
+
+using BlockStrings = std::array<std::u16string_view, stringsPerBlock>;
+
+TEST_CASE(StringTable, ParseComplete)
+{
+    auto data = MakeBlock({ u"", u"One", u"", u"Three" });
+    BlockStrings strings;
+    CHECK(l10n::ParseStringBlock(data, strings));
+    CHECK(strings[0].empty());
+    CHECK(strings[1] == u"One");
+    CHECK(strings[3] == u"Three");
+    CHECK(strings[15].empty());
+}
+
+TEST_CASE(StringTable, ParseEmpty)
+{
+    BlockStrings strings;
+    strings.fill(u"stale");
+    CHECK(!l10n::ParseStringBlock({}, strings));
+    for (auto str : strings)
+        CHECK(str.empty());
+}
+
+TEST_CASE(StringTable, ParseTruncated)
+{
+    auto data = MakeBlock({ u"One", u"Two", u"Three" });
+
+    // Cut off inside the third string: only the first two are returned
+    BlockStrings strings;
+    CHECK(!l10n::ParseStringBlock(std::span(data).first(10), strings));
+    CHECK(strings[0] == u"One");
+    CHECK(strings[1] == u"Two");
+    CHECK(strings[2].empty());
+
+    // Cut off after the third string, before the remaining length fields
+    CHECK(!l10n::ParseStringBlock(std::span(data).first(14), strings));
+    CHECK(strings[2] == u"Three");
+    CHECK(strings[3].empty());
+}
+
+TEST_CASE(StringTable, ParseLengthPastEnd)
+{
+    std::u16string data = MakeBlock({ u"One" });
+    data[4] = 0xffff;
+    BlockStrings strings;
+    CHECK(!l10n::ParseStringBlock(data, strings));
+    CHECK(strings[0] == u"One");
+    CHECK(strings[1].empty());
+}
+
+TEST_CASE(StringTable, OddLengthData)
+{
+    auto block = MakeBlock({ u"One", u"Two" });
+    std::vector<char16_t> buffer(block.begin(), block.end());
+    buffer.push_back(0);
+
+    // Trailing odd byte is ignored
+    auto data = l10n::StringBlockData(buffer.data(), block.size() * sizeof(char16_t) + 1);
+    CHECK(data.size() == block.size());
+    BlockStrings strings;
+    CHECK(l10n::ParseStringBlock(data, strings));
+    CHECK(strings[1] == u"Two");
+
+    // Last string with its final code unit cut in half
+    auto last_block = MakeBlock({});
+    last_block.back() = 1;
+    last_block.push_back(u'X');
+    data = l10n::StringBlockData(last_block.data(), last_block.size() * sizeof(char16_t) - 1);
+    CHECK(!l10n::ParseStringBlock(data, strings));
+    CHECK(strings[15].empty());
+}
+
+TEST_CASE(StringTable, LookupAndFallback)
+{
+    // Block 2 covers ids 16 to 31
+    auto preferred = MakeBlock({ u"", u"Eins" });
+    auto fallback = MakeBlock({ u"Zero", u"One", u"Two" });
+    auto other = MakeBlock({ u"Sixty-four" });
+
+    l10n::StringTable table;
+    CHECK(table.AddBlock(2, preferred));
+    CHECK(table.AddBlock(2, fallback));
+    CHECK(table.AddBlock(5, other));
+    CHECK(!table.AddBlock(0, other));
+
+    CHECK(table.Find(16) == u"Zero");
+    CHECK(table.Find(17) == u"Eins");
+    CHECK(table.Find(18) == u"Two");
+    CHECK(table.Find(64) == u"Sixty-four");
+    CHECK(table.Find(19).empty());
+    CHECK(table.Find(0).empty());
+    CHECK(table.Find(1000).empty());
+    CHECK(table.CountStrings() == 4);
+}
+
+TEST_CASE(StringTable, BlocksInAnyOrder)
+{
+    auto high = MakeBlock({ u"High" });
+    auto low = MakeBlock({ u"", u"", u"Low" });
+
+    l10n::StringTable table;
+    table.AddBlock(10, high);
+    table.AddBlock(1, low);
+    CHECK(table.Find(144) == u"High");
+    CHECK(table.Find(2) == u"Low");
+    CHECK(table.CountStrings() == 2);
+}
@@ -0,0 +1,142 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include "SwitchCoalescer.h"
+
+#include <atomic>
+#include <thread>
+
+using Request = hdr::SwitchCoalescer::Request;
+
+TEST_CASE(SwitchCoalescer, RequestsDuringSwitchMerged)
+{
+    hdr::VirtualClock clock;
+    hdr::SwitchCoalescer coalescer(clock);
+    auto first = coalescer.Add(Request::Enable);
+    CHECK(coalescer.BeginSwitch() == Request::Enable);
+
+    auto second = coalescer.Add(Request::Disable);
+    auto third = coalescer.Add(Request::Enable);
+    CHECK(!coalescer.IsDone(first));
+    coalescer.EndSwitch();
+    CHECK(coalescer.IsDone(first));
+    CHECK(!coalescer.IsDone(second));
+
+    // Spaced from the previous switch
+    CHECK(!coalescer.BeginSwitch());
+    clock.Advance(std::chrono::milliseconds(500));
+    CHECK(coalescer.BeginSwitch() == Request::Enable);
+    coalescer.EndSwitch();
+    CHECK(coalescer.IsDone(second));
+    CHECK(coalescer.IsDone(third));
+
+    auto stats = coalescer.GetStats();
+    CHECK(stats.requests == 3);
+    CHECK(stats.coalesced == 1);
+    CHECK(stats.executed == 2);
+}
+
+TEST_CASE(SwitchCoalescer, CancelledTogglesDone)
+{
+    hdr::VirtualClock clock;
+    hdr::SwitchCoalescer coalescer(clock);
+    auto first = coalescer.Add(Request::Toggle);
+    auto second = coalescer.Add(Request::Toggle);
+    CHECK(coalescer.IsDone(first));
+    CHECK(coalescer.IsDone(second));
+    CHECK(!coalescer.IsBusy());
+    CHECK(!coalescer.BeginSwitch());
+}
+
+TEST_CASE(SwitchCoalescer, CancelledTogglesWaitForRunningSwitch)
+{
+    hdr::VirtualClock clock;
+    hdr::SwitchCoalescer coalescer(clock);
+    auto first = coalescer.Add(Request::Toggle);
+    CHECK(coalescer.BeginSwitch() == Request::Toggle);
+
+    coalescer.Add(Request::Toggle);
+    auto third = coalescer.Add(Request::Toggle);
+    CHECK(!coalescer.IsDone(first));
+    CHECK(!coalescer.IsDone(third));
+    coalescer.EndSwitch();
+    CHECK(coalescer.IsDone(first));
+    CHECK(coalescer.IsDone(third));
+}
+
+TEST_CASE(SwitchCoalescer, ResetStats)
+{
+    hdr::VirtualClock clock;
+    hdr::SwitchCoalescer coalescer(clock);
+    coalescer.Add(Request::Enable);
+    coalescer.Add(Request::Disable);
+    coalescer.ResetStats();
+
+    auto stats = coalescer.GetStats();
+    CHECK(stats.requests == 0);
+    CHECK(stats.coalesced == 0);
+    CHECK(stats.executed == 0);
+    // Pending request is kept
+    CHECK(coalescer.BeginSwitch() == Request::Disable);
+}
+
+TEST_CASE(SwitchCoalescer, WaitDoneWhileSwitchRuns)
+{
+    hdr::VirtualClock clock;
+    hdr::SwitchCoalescer coalescer(clock, { .min_interval = hdr::Clock::duration::zero() });
+    coalescer.Add(Request::Enable);
+    CHECK(coalescer.BeginSwitch() == Request::Enable);
+
+    // Requests added during the switch are merged; exactly one of the waiting threads performs them
+    auto second = coalescer.Add(Request::Disable);
+    auto third = coalescer.Add(Request::Enable);
+    std::atomic<int> num_performed = 0;
+    auto waiter = [&](uint64_t ticket) {
+        while (auto request = coalescer.WaitDone(ticket)) {
+            CHECK(*request == Request::Enable);
+            num_performed++;
+            coalescer.EndSwitch();
+        }
+    };
+    std::thread second_thread(waiter, second);
+    std::thread third_thread(waiter, third);
+    coalescer.EndSwitch();
+    second_thread.join();
+    third_thread.join();
+
+    CHECK(num_performed == 1);
+    CHECK(coalescer.GetStats().executed == 2);
+}
+
+TEST_CASE(SwitchCoalescer, WaitDoneSpacesSwitches)
+{
+    auto min_interval = std::chrono::milliseconds(20);
+    hdr::SwitchCoalescer coalescer(hdr::SteadyClock::Get(), { .min_interval = min_interval });
+    coalescer.Add(Request::Enable);
+    CHECK(coalescer.BeginSwitch() == Request::Enable);
+    coalescer.EndSwitch();
+
+    auto start = std::chrono::steady_clock::now();
+    auto ticket = coalescer.Add(Request::Disable);
+    CHECK(coalescer.WaitDone(ticket) == Request::Disable);
+    CHECK(std::chrono::steady_clock::now() - start >= min_interval);
+    coalescer.EndSwitch();
+    CHECK(!coalescer.WaitDone(ticket));
+}
@@ -0,0 +1,42 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_TEST_H_
+#define TEST_TEST_H_
+
+/**
+ * Minimal test harness: test cases register themselves, grouped into suites, and
+ * CHECK() records failures without aborting the test case.
+ */
+namespace test {
+using TestFunc = void (*)();
+
+/// Register a test case. Use TEST_CASE() instead of calling this directly
+bool Register(const char* suite, const char* name, TestFunc func);
+/// Record the result of a check. Use CHECK() instead of calling this directly
+bool Check(bool ok, const char* expr, const char* file, int line);
+} // namespace test
+
+#define TEST_CASE(suite, name)                                                                                         \
+    static void suite##_##name();                                                                                      \
+    [[maybe_unused]] static const bool suite##_##name##_registered = test::Register(#suite, #name, &suite##_##name);  \
+    static void suite##_##name()
+
+#define CHECK(expr) test::Check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+#endif // TEST_TEST_H_
@@ -0,0 +1,84 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include <print>
+#include <string_view>
+#include <vector>
+
+namespace test {
+namespace {
+struct TestCase
+{
+    std::string_view suite;
+    std::string_view name;
+    TestFunc func;
+};
+} // anonymous namespace
+
+static std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> test_cases;
+    return test_cases;
+}
+
+static const TestCase* current_test;
+static size_t num_failed_checks;
+
+bool Register(const char* suite, const char* name, TestFunc func)
+{
+    GetTestCases().push_back({ suite, name, func });
+    return true;
+}
+
+bool Check(bool ok, const char* expr, const char* file, int line)
+{
+    if (!ok) {
+        std::println(stderr, "{}:{}: {}.{}: check failed: {}", file, line, current_test->suite, current_test->name,
+                     expr);
+        num_failed_checks++;
+    }
+    return ok;
+}
+} // namespace test
+
+/* Usage: hdr_tests [SUITE]
+ * Runs all test cases, or the ones in the given suite. */
+int main(int argc, char* argv[])
+{
+    std::string_view suite = argc > 1 ? argv[1] : "";
+
+    size_t num_run = 0;
+    size_t num_failed = 0;
+    for (const auto& test_case : test::GetTestCases()) {
+        if (!suite.empty() && test_case.suite != suite)
+            continue;
+
+        test::current_test = &test_case;
+        auto failed_checks_before = test::num_failed_checks;
+        test_case.func();
+        num_run++;
+        if (test::num_failed_checks != failed_checks_before)
+            num_failed++;
+    }
+
+    std::println("{} test case(s) run, {} failed", num_run, num_failed);
+    // Running nothing is an error, too: probably a misspelled suite
+    return num_run > 0 && num_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+#include "AllocationCounter.h"
+#include "ScopedBackend.h"
+
+#include "DisplayConfigSim.h"
+#include "DisplayList.h"
+#include "HDR.h"
+#include "RecheckScheduler.h"
+
+using hdr::display_config::Call;
+using hdr::display_config::MakeExtendedTopology;
+using hdr::display_config::SimulatedBackend;
+
+TEST_CASE(Topology, RetryOnSizeRace)
+{
+    SimulatedBackend backend(MakeExtendedTopology(2));
+    test::ScopedBackend scoped_backend(backend);
+    CHECK(hdr::GetDisplays().size() == 2);
+
+    // Display plugged in between getting the buffer sizes and querying
+    backend.QueueHotplug(MakeExtendedTopology(4));
+    hdr::InvalidateTopology();
+    backend.ResetStats();
+    CHECK(hdr::GetDisplays().size() == 4);
+    CHECK(backend.GetStats(Call::GetBufferSizes).count == 2);
+    CHECK(backend.GetStats(Call::QueryConfig).count == 2);
+
+    // Display unplugged: the buffer is large enough, no retry needed
+    backend.QueueHotplug(MakeExtendedTopology(1));
+    hdr::InvalidateTopology();
+    backend.ResetStats();
+    CHECK(hdr::GetDisplays().size() == 1);
+    CHECK(backend.GetStats(Call::GetBufferSizes).count == 1);
+}
+
+TEST_CASE(Topology, RetriesAreBounded)
+{
+    SimulatedBackend backend(MakeExtendedTopology(1));
+    test::ScopedBackend scoped_backend(backend);
+
+    // Topology grows during every attempt
+    for (size_t num_displays = 2; num_displays <= 5; num_displays++)
+        backend.QueueHotplug(MakeExtendedTopology(num_displays));
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Unsupported);
+    CHECK(backend.GetStats(Call::GetBufferSizes).count == 4);
+
+    // The failed query is not kept: the next call queries again, without invalidating
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Off);
+    CHECK(hdr::GetDisplays().size() == 5);
+}
+
+TEST_CASE(Topology, FailedQueryNotCached)
+{
+    SimulatedBackend backend(MakeExtendedTopology(2));
+    test::ScopedBackend scoped_backend(backend);
+
+    backend.SetFailureRate(Call::GetBufferSizes, 1);
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Unsupported);
+    CHECK(hdr::GetDisplays().empty());
+
+    backend.SetFailureRate(Call::GetBufferSizes, 0);
+    backend.SetFailureRate(Call::QueryConfig, 1);
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Unsupported);
+
+    backend.SetFailureRate(Call::QueryConfig, 0);
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Off);
+    CHECK(hdr::GetDisplays().size() == 2);
+}
+
+TEST_CASE(Topology, FailedNameNotCached)
+{
+    SimulatedBackend backend(MakeExtendedTopology(2));
+    test::ScopedBackend scoped_backend(backend);
+
+    backend.SetFailureRate(Call::GetTargetName, 1);
+    CHECK(hdr::GetDisplays().empty());
+    hdr::DisplayList list;
+    hdr::GetDisplays(list);
+    CHECK(list.GetDisplays().empty());
+
+    backend.SetFailureRate(Call::GetTargetName, 0);
+    CHECK(hdr::GetDisplays().size() == 2);
+    hdr::GetDisplays(list);
+    CHECK(list.GetDisplays().size() == 2);
+
+    // Known names aren't queried again
+    backend.ResetStats();
+    hdr::GetDisplays();
+    CHECK(backend.GetStats(Call::GetTargetName).count == 0);
+}
+
+// Re-checks like HDRTray's after WM_DISPLAYCHANGE: only the status is invalidated
+TEST_CASE(Topology, StatusRecheckKeepsTopology)
+{
+    auto displays = MakeExtendedTopology(2);
+    SimulatedBackend backend(displays);
+    test::ScopedBackend scoped_backend(backend);
+    CHECK(hdr::GetWindowsHDRStatus() == hdr::Status::Off);
+
+    hdr::VirtualClock clock;
+    hdr::RecheckScheduler scheduler(clock);
+    scheduler.NotifyChange();
+    backend.ResetStats();
+    int num_checks = 0;
+    bool saw_change = false;
+    while (auto wait = scheduler.TimeUntilNextCheck()) {
+        clock.Advance(*wait);
+        if (!scheduler.CheckDue())
+            continue;
+        // HDR gets turned on by someone else after a few checks
+        if (++num_checks == 3) {
+            for (auto& disp : displays)
+                disp.hdr_enabled = true;
+            backend.SetDisplays(displays);
+        }
+        hdr::InvalidateStatus();
+        bool changed = hdr::GetWindowsHDRStatus() == hdr::Status::On && !saw_change;
+        saw_change |= changed;
+        scheduler.CheckDone(changed);
+    }
+    CHECK(saw_change);
+    CHECK(num_checks >= 3);
+    CHECK(backend.GetStats(Call::GetBufferSizes).count == 0);
+    CHECK(backend.GetStats(Call::QueryConfig).count == 0);
+    CHECK(backend.GetStats(Call::GetTargetName).count == 0);
+}
+
+TEST_CASE(Topology, StatusPollingDoesNotAllocate)
+{
+    SimulatedBackend backend(MakeExtendedTopology(4));
+    test::ScopedBackend scoped_backend(backend);
+    hdr::GetWindowsHDRStatus();
+
+    auto allocations_before = test::CountAllocations();
+    for (int i = 0; i < 10; i++) {
+        hdr::InvalidateStatus();
+        hdr::GetWindowsHDRStatus();
+    }
+    CHECK(test::CountAllocations() == allocations_before);
+}
+
+TEST_CASE(Topology, ReusedDisplayListDoesNotAllocate)
+{
+    SimulatedBackend backend(MakeExtendedTopology(4));
+    test::ScopedBackend scoped_backend(backend);
+    hdr::DisplayList list;
+    hdr::GetDisplays(list);
+
+    auto allocations_before = test::CountAllocations();
+    for (int i = 0; i < 10; i++) {
+        hdr::InvalidateStatus();
+        hdr::GetDisplays(list);
+    }
+    CHECK(test::CountAllocations() == allocations_before);
+    CHECK(list.GetDisplays().size() == 4);
+}
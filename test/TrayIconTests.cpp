@@ -0,0 +1,125 @@
+/*
+    HDRTray, a notification icon for the "Use HDR" option
+    Copyright (C) 2025 Frank Richter
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Test.h"
+
+#include "TrayIcon.h"
+
+namespace {
+/// Shell counting the calls made to it
+class CountingShell : public tray::Shell
+{
+public:
+    int num_adds = 0;
+    int num_modifies = 0;
+    int num_deletes = 0;
+    /// Fields passed to the last Modify() call
+    unsigned last_fields = 0;
+    /// Whether Modify() calls succeed
+    bool modify_ok = true;
+
+    int CountCalls() const { return num_adds + num_modifies + num_deletes; }
+
+    bool Add(const tray::IconState&) override
+    {
+        num_adds++;
+        return true;
+    }
+    bool Modify(const tray::IconState&, unsigned fields) override
+    {
+        num_modifies++;
+        last_fields = fields;
+        return modify_ok;
+    }
+    bool Delete() override
+    {
+        num_deletes++;
+        return true;
+    }
+    bool ShowErrorBalloon(std::wstring_view) override { return true; }
+};
+} // anonymous namespace
+
+// Distinct, never dereferenced icon "handles"
+static const int icon_on = 0;
+static const int icon_off = 0;
+
+TEST_CASE(TrayIcon, IdenticalUpdatesMakeNoCalls)
+{
+    CountingShell shell;
+    tray::IconStateTracker tracker(shell);
+    tray::IconState state { &icon_off, L"HDR is off" };
+    CHECK(tracker.Add(state));
+    CHECK(shell.CountCalls() == 1);
+
+    for (int i = 0; i < 100; i++)
+        CHECK(tracker.Update(state));
+    CHECK(shell.CountCalls() == 1);
+}
+
+TEST_CASE(TrayIcon, OnlyChangedFieldsSent)
+{
+    CountingShell shell;
+    tray::IconStateTracker tracker(shell);
+    tracker.Add({ &icon_off, L"HDR is off" });
+
+    tracker.Update({ &icon_on, L"HDR is off" });
+    CHECK(shell.num_modifies == 1 && shell.last_fields == tray::IconFieldIcon);
+    tracker.Update({ &icon_on, L"HDR is on" });
+    CHECK(shell.num_modifies == 2 && shell.last_fields == tray::IconFieldTip);
+    tracker.Update({ &icon_off, L"HDR is off" });
+    CHECK(shell.num_modifies == 3 && shell.last_fields == (tray::IconFieldIcon | tray::IconFieldTip));
+}
+
+TEST_CASE(TrayIcon, NoUpdateWhenNotAdded)
+{
+    CountingShell shell;
+    tray::IconStateTracker tracker(shell);
+    CHECK(!tracker.Update({ &icon_off, L"HDR is off" }));
+    CHECK(shell.CountCalls() == 0);
+
+    tracker.Add({ &icon_off, L"HDR is off" });
+    tracker.Remove();
+    CHECK(!tracker.IsAdded());
+    CHECK(!tracker.Update({ &icon_on, L"HDR is on" }));
+    CHECK(shell.num_modifies == 0);
+}
+
+TEST_CASE(TrayIcon, FailedModifyRetried)
+{
+    CountingShell shell;
+    tray::IconStateTracker tracker(shell);
+    tracker.Add({ &icon_off, L"HDR is off" });
+
+    shell.modify_ok = false;
+    CHECK(!tracker.Update({ &icon_on, L"HDR is on" }));
+    shell.modify_ok = true;
+    CHECK(tracker.Update({ &icon_on, L"HDR is on" }));
+    CHECK(shell.num_modifies == 2);
+}
+
+TEST_CASE(TrayIcon, InvalidatedIconResent)
+{
+    CountingShell shell;
+    tray::IconStateTracker tracker(shell);
+    tracker.Add({ &icon_off, L"HDR is off" });
+
+    tracker.InvalidateIcon();
+    tracker.Update({ &icon_off, L"HDR is off" });
+    CHECK(shell.num_modifies == 1 && shell.last_fields == tray::IconFieldIcon);
+}